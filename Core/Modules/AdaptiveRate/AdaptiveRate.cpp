@@ -0,0 +1,106 @@
+/*
+ * AdaptiveRate.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "AdaptiveRate.hpp"
+
+AdaptiveRate::AdaptiveRate()
+{
+	configure(1, 60, 0.05, 3);
+}
+
+void AdaptiveRate::configure( uint32_t minPeriod_p, uint32_t maxPeriod_p, float step_p, uint32_t budgetPeriod_p )
+{
+	if( minPeriod_p == 0 ) { minPeriod_p = 1; }
+	if( maxPeriod_p > UINT16_MAX ) { maxPeriod_p = UINT16_MAX; }
+	if( maxPeriod_p < minPeriod_p ) { maxPeriod_p = minPeriod_p; }
+	if( budgetPeriod_p == 0 ) { budgetPeriod_p = 1; }
+	if( step_p <= 0 ) { step_p = 0.01; }
+
+	minPeriod = minPeriod_p;
+	maxPeriod = maxPeriod_p;
+	budgetPeriod = budgetPeriod_p;
+	step = step_p;
+
+	hasLast = false;
+	rate = 0;
+
+	//One write is available at the start
+	credit = budgetPeriod;
+	period = (budgetPeriod < minPeriod) ? minPeriod : budgetPeriod;
+	if( period > maxPeriod ) { period = maxPeriod; }
+}
+
+void AdaptiveRate::setBudgetPeriod( uint32_t budgetPeriod_p )
+{
+	if( budgetPeriod_p == 0 ) { budgetPeriod_p = 1; }
+
+	budgetPeriod = budgetPeriod_p;
+	if( credit > (int32_t)budgetPeriod ) { credit = budgetPeriod; }
+}
+
+uint32_t AdaptiveRate::update( const float* values_p, uint8_t count_p, uint32_t elapsed_p )
+{
+	if( count_p > ADAPTIVERATE_MAX_CHANNELS ) { count_p = ADAPTIVERATE_MAX_CHANNELS; }
+
+	//The bucket fills with the elapsed time, a write costs one budget period
+	credit += elapsed_p;
+	if( credit > (int32_t)(budgetPeriod * ADAPTIVERATE_BUCKET_DEPTH) ) { credit = budgetPeriod * ADAPTIVERATE_BUCKET_DEPTH; }
+	credit -= budgetPeriod;
+
+	//Largest |dT/dt| of the channels
+	if( hasLast && elapsed_p != 0 )
+	{
+		float newRate = 0;
+		for(uint8_t i = 0; i < count_p; i++)
+		{
+			float change = values_p[i] - lastValues[i];
+			if( change < 0 ) { change = -change; }
+			if( change / elapsed_p > newRate ) { newRate = change / elapsed_p; }
+		}
+
+		//Fast attack, slow decay, so the noise of a flat signal does not shorten the period
+		if( newRate > rate ) { rate = newRate; }
+		else { rate += (newRate - rate) / 4; }
+	}
+
+	for(uint8_t i = 0; i < count_p; i++) { lastValues[i] = values_p[i]; }
+	hasLast = true;
+
+	uint32_t next = maxPeriod;
+	if( rate * maxPeriod > step )
+	{
+		next = (uint32_t)(step / rate);
+	}
+
+	if( next > period * 2 ) { next = period * 2; }
+	if( next < minPeriod ) { next = minPeriod; }
+	if( next > maxPeriod ) { next = maxPeriod; }
+
+	//The next write must be paid for when it is due
+	if( credit + (int32_t)next < (int32_t)budgetPeriod )
+	{
+		next = budgetPeriod - credit;
+	}
+
+	period = next;
+	return period;
+}
+
+uint32_t AdaptiveRate::getPeriod()
+{
+	return period;
+}
+
+uint32_t AdaptiveRate::getMinPeriod()
+{
+	return minPeriod;
+}
+
+float AdaptiveRate::getRate()
+{
+	return rate;
+}
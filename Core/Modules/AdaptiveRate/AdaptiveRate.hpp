@@ -0,0 +1,105 @@
+/**
+ * @file AdaptiveRate.hpp
+ * @brief Logging period controller driven by the rate of change of the measured values.
+ *
+ * @details After every logged sample the largest |dT/dt| of the channels is estimated, and the next period is chosen so that
+ * the expected change between two samples is about a given step: transients are sampled fast, flat signals slowly,
+ * always within the configured bounds. A token bucket keeps the average write rate at or below the one of a fixed period,
+ * the fast periods of a transient are paid for with the slow ones before it.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_ADAPTIVERATE_ADAPTIVERATE_HPP_
+#define MODULES_ADAPTIVERATE_ADAPTIVERATE_HPP_
+
+#include <stdint.h>
+
+/// Maximum number of channels followed by the controller
+#define ADAPTIVERATE_MAX_CHANNELS 8
+
+/// Number of writes that can be saved up in the token bucket
+#define ADAPTIVERATE_BUCKET_DEPTH 64
+
+/**
+ * @brief Class for choosing the logging period
+ *
+ * Every period is given in seconds, as the logging timer ticks every second.
+ *
+ * Example:
+	* \code
+	AdaptiveRate myRate;
+	myRate.configure(1, 60, 0.05, 3);
+	⋮
+	//After every logged sample
+	period = myRate.update(temperatures, channelCount, elapsed);
+ * \endcode
+ */
+class AdaptiveRate{
+private:
+	uint32_t minPeriod;		///< Shortest period [s]
+	uint32_t maxPeriod;		///< Longest period [s]
+	uint32_t budgetPeriod;	///< Average period that must not be undercut, cost of one write in the bucket [s]
+	float step;				///< Wanted change between two samples [C]
+
+	float lastValues[ADAPTIVERATE_MAX_CHANNELS];	///< The values of the previous sample
+	bool hasLast = false;							///< False until the first sample
+	float rate = 0;									///< Estimated largest |dT/dt| [C/s]
+
+	int32_t credit;			///< Content of the token bucket [s]
+	uint32_t period;		///< The last chosen period [s]
+
+public:
+	/**
+	 * @brief Constructor for the AdaptiveRate class
+	 */
+	AdaptiveRate();
+
+	/**
+	 * @brief Set the bounds, the wanted step and the write budget, restarts the estimation
+	 *
+	 * @param minPeriod_p shortest period in s (at least 1)
+	 * @param maxPeriod_p longest period in s (at most UINT16_MAX, so it fits into deltaT)
+	 * @param step_p wanted change between two samples in celsius
+	 * @param budgetPeriod_p the average period must not be shorter than this (e.g. the fixed period used without the controller)
+	 */
+	void configure( uint32_t minPeriod_p, uint32_t maxPeriod_p, float step_p, uint32_t budgetPeriod_p );
+
+	/**
+	 * @brief Change the write budget, the bounds and the estimation are kept
+	 *
+	 * @param budgetPeriod_p the average period must not be shorter than this
+	 */
+	void setBudgetPeriod( uint32_t budgetPeriod_p );
+
+	/**
+	 * @brief Feed in a logged sample and get the next period
+	 *
+	 * The period shrinks at once when the signal speeds up, but grows at most to its double per sample,
+	 * so a short pause in a transient does not lose the rest of it.
+	 *
+	 * @param values_p the logged value of every channel
+	 * @param count_p number of channels
+	 * @param elapsed_p time since the previous sample in s
+	 *
+	 * @returns The period until the next sample in s
+	 */
+	uint32_t update( const float* values_p, uint8_t count_p, uint32_t elapsed_p );
+
+	/**
+	 * @brief Get the last chosen period in s
+	 */
+	uint32_t getPeriod();
+
+	/**
+	 * @brief Get the shortest allowed period in s
+	 */
+	uint32_t getMinPeriod();
+
+	/**
+	 * @brief Get the estimated largest rate of change in C/s
+	 */
+	float getRate();
+};
+
+#endif /* MODULES_ADAPTIVERATE_ADAPTIVERATE_HPP_ */
@@ -0,0 +1,128 @@
+/*
+ * AlarmCapture.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "AlarmCapture.hpp"
+
+AlarmCapture::AlarmCapture( uint8_t pre_p, uint8_t post_p )
+{
+	preSamples = pre_p;
+	postSamples = post_p;
+}
+
+void AlarmCapture::configure( uint8_t pre_p, uint8_t post_p )
+{
+	//The trigger sample is also part of the burst
+	if( pre_p > ALARMCAPTURE_RING_SIZE - 1 ) { pre_p = ALARMCAPTURE_RING_SIZE - 1; }
+	if( pre_p + post_p > ALARMCAPTURE_RING_SIZE - 1 ) { post_p = ALARMCAPTURE_RING_SIZE - 1 - pre_p; }
+
+	preSamples = pre_p;
+	postSamples = post_p;
+
+	head = 0;
+	fill = 0;
+	rearm();
+}
+
+void AlarmCapture::setLimits( uint16_t low_p, uint16_t high_p )
+{
+	lowLimit = low_p;
+	highLimit = high_p;
+}
+
+bool AlarmCapture::push( uint16_t sample_p, AlarmCause_t trigger_p )
+{
+	if( state == ALARM_DISABLED || state == ALARM_FROZEN )
+	{
+		return false;
+	}
+
+	ring[head] = sample_p;
+	head = (head + 1) & (ALARMCAPTURE_RING_SIZE - 1);
+	if( fill < ALARMCAPTURE_RING_SIZE ) { fill++; }
+
+	if( trigger_p == ALARM_CAUSE_NONE )
+	{
+		if( sample_p > highLimit ) 		{ trigger_p = ALARM_CAUSE_HIGH_LIMIT; }
+		else if( sample_p < lowLimit ) 	{ trigger_p = ALARM_CAUSE_LOW_LIMIT; }
+	}
+
+	//Only entering the alarm range triggers, staying there does not fill the storage with bursts
+	bool wasOutside = outside;
+	outside = ( trigger_p != ALARM_CAUSE_NONE );
+
+	if( state == ALARM_ARMED )
+	{
+		if( outside && !wasOutside )
+		{
+			cause = trigger_p;
+			postRemaining = postSamples;
+			state = ALARM_POST_TRIGGER;
+		}
+	}
+	else if( postRemaining != 0 )
+	{
+		postRemaining--;
+	}
+
+	if( state == ALARM_POST_TRIGGER && postRemaining == 0 )
+	{
+		state = ALARM_FROZEN;
+		return true;
+	}
+
+	return false;
+}
+
+bool AlarmCapture::isFrozen()
+{
+	return state == ALARM_FROZEN;
+}
+
+uint8_t AlarmCapture::getBurst( uint16_t* buffer_p, uint8_t* trigger_p )
+{
+	if( state != ALARM_FROZEN )
+	{
+		return 0;
+	}
+
+	//Fewer pre-trigger samples, if the trigger came soon after arming
+	uint8_t len = preSamples + 1 + postSamples;
+	if( len > fill ) { len = fill; }
+
+	uint8_t start = (head - len) & (ALARMCAPTURE_RING_SIZE - 1);
+	for(uint8_t i = 0; i < len; i++)
+	{
+		buffer_p[i] = ring[(start + i) & (ALARMCAPTURE_RING_SIZE - 1)];
+	}
+
+	if( trigger_p != NULL ) { *trigger_p = len - 1 - postSamples; }
+
+	return len;
+}
+
+AlarmCause_t AlarmCapture::getCause()
+{
+	return cause;
+}
+
+void AlarmCapture::rearm()
+{
+	//The ring is kept, it is the history of a crossing that comes soon after this one
+	postRemaining = 0;
+	cause = ALARM_CAUSE_NONE;
+	state = ALARM_ARMED;
+}
+
+void AlarmCapture::disable()
+{
+	state = ALARM_DISABLED;
+}
+
+AlarmCaptureState_t AlarmCapture::getState()
+{
+	return state;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file AlarmCapture.hpp
+ * @brief Pre-trigger capture of full-rate sensor samples around an alarm.
+ *
+ * @details Every conversion is written into a RAM ring buffer. While armed, each sample is compared with a low and a high limit,
+ * and an external trigger (e.g. a threshold flag of the sensor) can also be given. On a trigger the capture keeps recording
+ * the post-trigger samples, then freezes, so the history before and after the event can be stored as one burst,
+ * while the periodic log keeps its low rate.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_ALARMCAPTURE_ALARMCAPTURE_HPP_
+#define MODULES_ALARMCAPTURE_ALARMCAPTURE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Size of the ring buffer, the longest burst that can be captured (must be a power of two)
+#define ALARMCAPTURE_RING_SIZE 64
+
+/// Default number of samples kept from before the trigger
+#define ALARMCAPTURE_DEFAULT_PRE 40
+
+/// Default number of samples recorded after the trigger
+#define ALARMCAPTURE_DEFAULT_POST 23
+
+/**
+ * @enum AlarmCaptureState_t
+ * @brief The states of the capture.
+ */
+typedef enum{
+	ALARM_DISABLED = 0,		/*!< Samples are not recorded */
+	ALARM_ARMED,			/*!< Recording, waiting for a trigger */
+	ALARM_POST_TRIGGER,		/*!< Triggered, recording the post-trigger samples */
+	ALARM_FROZEN,			/*!< The burst is complete and waits to be read out */
+} AlarmCaptureState_t;
+
+/**
+ * @enum AlarmCause_t
+ * @brief What triggered the capture.
+ */
+typedef enum{
+	ALARM_CAUSE_NONE = 0,		/*!< No trigger */
+	ALARM_CAUSE_HIGH_THRESHOLD,	/*!< External trigger, e.g. the High Fault Threshold of a MAX31865 */
+	ALARM_CAUSE_LOW_THRESHOLD,	/*!< External trigger, e.g. the Low Fault Threshold of a MAX31865 */
+	ALARM_CAUSE_HIGH_LIMIT,		/*!< The sample was above the software high limit */
+	ALARM_CAUSE_LOW_LIMIT,		/*!< The sample was below the software low limit */
+} AlarmCause_t;
+
+/**
+ * @brief Class for capturing the samples around an alarm
+ *
+ * The limits are compared with the raw samples, so no conversion is needed on every sample.
+ * Only entering the alarm range triggers, a new burst is captured after the signal has returned and crossed again.
+ *
+ * Example:
+	* \code
+	AlarmCapture myCapture;
+	myCapture.setLimits(lowRaw, highRaw);
+	myCapture.configure(40, 23);
+	⋮
+	//On every new conversion
+	myCapture.push(rawSample);
+	⋮
+	if( myCapture.isFrozen() )
+	{
+		uint16_t burst[ALARMCAPTURE_RING_SIZE];
+		uint8_t len = myCapture.getBurst(burst);
+		⋮
+		myCapture.rearm();
+	}
+ * \endcode
+ */
+class AlarmCapture{
+private:
+	uint16_t ring[ALARMCAPTURE_RING_SIZE];	///< The last samples, the oldest is overwritten
+	uint8_t head = 0;						///< Where the next sample is written
+	uint8_t fill = 0;						///< Number of valid samples in the ring
+
+	uint8_t preSamples;						///< Samples kept from before the trigger
+	uint8_t postSamples;					///< Samples recorded after the trigger
+	uint8_t postRemaining = 0;				///< Post-trigger samples still to be recorded
+
+	uint16_t lowLimit = 0;					///< Samples below this trigger the capture
+	uint16_t highLimit = UINT16_MAX;		///< Samples above this trigger the capture
+
+	bool outside = false;					///< True if the last sample was in the alarm range
+
+	AlarmCaptureState_t state = ALARM_DISABLED;
+	AlarmCause_t cause = ALARM_CAUSE_NONE;
+
+public:
+	/**
+	 * @brief Constructor for the AlarmCapture class, the capture starts disabled
+	 *
+	 * @param pre_p number of samples kept from before the trigger
+	 * @param post_p number of samples recorded after the trigger
+	 */
+	AlarmCapture( uint8_t pre_p = ALARMCAPTURE_DEFAULT_PRE, uint8_t post_p = ALARMCAPTURE_DEFAULT_POST );
+
+	/**
+	 * @brief Set the length of the burst, clears the recorded samples and arms the capture
+	 *
+	 * The pre- and post-trigger samples and the trigger itself have to fit into \link ALARMCAPTURE_RING_SIZE \endlink,
+	 * the post-trigger part is shortened if they do not.
+	 *
+	 * @param pre_p number of samples kept from before the trigger
+	 * @param post_p number of samples recorded after the trigger
+	 */
+	void configure( uint8_t pre_p, uint8_t post_p );
+
+	/**
+	 * @brief Set the software limits
+	 *
+	 * @param low_p samples below this trigger the capture (0 disables it)
+	 * @param high_p samples above this trigger the capture (UINT16_MAX disables it)
+	 */
+	void setLimits( uint16_t low_p, uint16_t high_p );
+
+	/**
+	 * @brief Record a new sample
+	 *
+	 * @param sample_p the new sample
+	 * @param trigger_p external trigger, \link ALARM_CAUSE_NONE \endlink if there is none
+	 *
+	 * @returns True if the burst has just been completed
+	 */
+	bool push( uint16_t sample_p, AlarmCause_t trigger_p = ALARM_CAUSE_NONE );
+
+	/**
+	 * @brief Check if a complete burst waits to be read out
+	 */
+	bool isFrozen();
+
+	/**
+	 * @brief Copy the captured burst, oldest sample first
+	 *
+	 * @param buffer_p where the samples are copied, at least \link ALARMCAPTURE_RING_SIZE \endlink long
+	 * @param trigger_p where the index of the trigger sample is stored (can be NULL)
+	 *
+	 * @returns The number of samples in the burst, 0 if there is no frozen burst
+	 */
+	uint8_t getBurst( uint16_t* buffer_p, uint8_t* trigger_p = NULL );
+
+	/**
+	 * @brief Get what triggered the last capture
+	 */
+	AlarmCause_t getCause();
+
+	/**
+	 * @brief Wait for the next trigger
+	 *
+	 * The recorded samples are kept, so the next burst has its pre-trigger history even if it comes soon after this one.
+	 */
+	void rearm();
+
+	/**
+	 * @brief Stop recording
+	 */
+	void disable();
+
+	/**
+	 * @brief Get the state of the capture
+	 */
+	AlarmCaptureState_t getState();
+};
+
+#endif /* MODULES_ALARMCAPTURE_ALARMCAPTURE_HPP_ */
@@ -0,0 +1,91 @@
+/*
+ * CommandTable.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "CommandTable.hpp"
+#include <stdlib.h>
+
+void CommandArgs::split( char* line_p )
+{
+	wordCount = 0;
+
+	while( *line_p != '\0' && wordCount < COMMANDTABLE_MAX_ARGS )
+	{
+		if( *line_p == ' ' )
+		{
+			line_p++;
+			continue;
+		}
+
+		words[wordCount++] = line_p;
+
+		while( *line_p != ' ' && *line_p != '\0' ) { line_p++; }
+		if( *line_p == ' ' ) { *line_p++ = '\0'; }
+	}
+}
+
+uint8_t CommandArgs::count()
+{
+	return wordCount;
+}
+
+const char* CommandArgs::get( uint8_t index_p )
+{
+	return (index_p < wordCount) ? words[index_p] : "";
+}
+
+bool CommandArgs::is( uint8_t index_p, const char* keyword_p )
+{
+	return index_p < wordCount && strcmp(words[index_p], keyword_p) == 0;
+}
+
+bool CommandArgs::getUInt( uint8_t index_p, uint32_t* value_p )
+{
+	uint64_t value;
+	if( !getUInt64(index_p, &value) || value > UINT32_MAX )
+	{
+		return false;
+	}
+
+	*value_p = (uint32_t)value;
+	return true;
+}
+
+bool CommandArgs::getUInt64( uint8_t index_p, uint64_t* value_p )
+{
+	if( index_p >= wordCount || words[index_p][0] == '-' )
+	{
+		return false;
+	}
+
+	char* end;
+	unsigned long long value = strtoull(words[index_p], &end, 10);
+	if( end == words[index_p] || *end != '\0' )
+	{
+		return false;
+	}
+
+	*value_p = value;
+	return true;
+}
+
+bool CommandArgs::getFloat( uint8_t index_p, float* value_p )
+{
+	if( index_p >= wordCount )
+	{
+		return false;
+	}
+
+	char* end;
+	float value = strtof(words[index_p], &end);
+	if( end == words[index_p] || *end != '\0' )
+	{
+		return false;
+	}
+
+	*value_p = value;
+	return true;
+}
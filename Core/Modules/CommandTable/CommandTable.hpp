@@ -0,0 +1,298 @@
+/**
+ * @file CommandTable.hpp
+ * @brief Command dispatcher built at compile time.
+ *
+ * @details The commands are listed in a constexpr array, one line each: name, handler, minimal number of arguments and help text.
+ * The names are hashed (FNV-1a) by the compiler and the open addressing table indexing the commands is also filled by the compiler,
+ * so finding the handler of a received line takes one hash and usually one string compare, independent of the number of commands.
+ * The arguments are split into words and converted by the handler with the typed getters of \link CommandArgs \endlink.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_COMMANDTABLE_COMMANDTABLE_HPP_
+#define MODULES_COMMANDTABLE_COMMANDTABLE_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/// Number of slots of the hash table, at least twice the number of commands (must be a power of two)
+#define COMMANDTABLE_SLOTS 64
+
+/// Most words of a line after the command name, the rest is dropped
+#define COMMANDTABLE_MAX_ARGS 6
+
+/// Marks an empty slot of the hash table
+#define COMMANDTABLE_EMPTY 0xFF
+
+/**
+ * @brief FNV-1a hash of a command name, evaluated by the compiler for the names of the table
+ */
+constexpr uint32_t commandHash( const char* name_p )
+{
+	uint32_t hash = 2166136261u;
+	while( *name_p != '\0' )
+	{
+		hash = (hash ^ (uint8_t)*name_p) * 16777619u;
+		name_p++;
+	}
+	return hash;
+}
+
+/**
+ * @brief The words of a received line after the command name
+ */
+class CommandArgs{
+private:
+	const char* words[COMMANDTABLE_MAX_ARGS];	///< The words, terminated in place in the line
+	uint8_t wordCount = 0;						///< Number of words
+
+public:
+	/**
+	 * @brief Split the rest of the line into words, the spaces are overwritten with '\0'
+	 */
+	void split( char* line_p );
+
+	/**
+	 * @brief Get the number of words
+	 */
+	uint8_t count();
+
+	/**
+	 * @brief Get a word, or an empty string if there is no such word
+	 */
+	const char* get( uint8_t index_p );
+
+	/**
+	 * @brief Check if a word equals a keyword
+	 */
+	bool is( uint8_t index_p, const char* keyword_p );
+
+	/**
+	 * @brief Convert a word to an unsigned integer
+	 *
+	 * @returns False if there is no such word or it is not a number, then the value is left unchanged (keeps its default)
+	 */
+	bool getUInt( uint8_t index_p, uint32_t* value_p );
+
+	/**
+	 * @brief Convert a word to a 64 bit unsigned integer
+	 *
+	 * @returns False if there is no such word or it is not a number, then the value is left unchanged (keeps its default)
+	 */
+	bool getUInt64( uint8_t index_p, uint64_t* value_p );
+
+	/**
+	 * @brief Convert a word to a float
+	 *
+	 * @returns False if there is no such word or it is not a number, then the value is left unchanged (keeps its default)
+	 */
+	bool getFloat( uint8_t index_p, float* value_p );
+};
+
+/**
+ * @typedef Command_Handler
+ * @brief Handler of a command, called in the main context with the arguments of the line
+ */
+typedef void(*Command_Handler)( CommandArgs& args_p );
+
+/**
+ * @struct Command_t
+ * @brief One line of the command list
+ */
+typedef struct{
+	uint32_t hash;				/*!< Hash of the name, calculated by the compiler */
+	const char* name;			/*!< The command word */
+	Command_Handler handler;	/*!< Called with the arguments */
+	uint8_t minArgs;			/*!< A line with fewer arguments is rejected */
+	const char* help;			/*!< Arguments and description, listed by the help command */
+} Command_t;
+
+/**
+ * @struct Command_Stats_t
+ * @brief Statistics of a command
+ */
+typedef struct{
+	uint32_t count;			/*!< Number of handled lines */
+	uint32_t rejected;		/*!< Lines rejected for missing arguments */
+	uint32_t maxCycles;		/*!< Longest run of the handler [cycles] */
+} Command_Stats_t;
+
+/**
+ * @typedef Command_Result_t
+ * @brief Result of dispatching a line
+ */
+typedef enum{
+	COMMAND_OK,			//The handler has run
+	COMMAND_EMPTY,		//Nothing but spaces
+	COMMAND_UNKNOWN,	//No such command
+	COMMAND_REJECTED,	//Too few arguments
+} Command_Result_t;
+
+/**
+ * @brief Make a line of the command list, the hash of the name is calculated by the compiler
+ */
+constexpr Command_t command( const char* name_p, Command_Handler handler_p, uint8_t minArgs_p, const char* help_p )
+{
+	return Command_t{ commandHash(name_p), name_p, handler_p, minArgs_p, help_p };
+}
+
+/**
+ * @brief Class of the dispatcher of a command list
+ *
+ * The constructor is constexpr, so a global table is filled by the compiler and placed in the initialized data.
+ * The handlers run with the DWT cycle counter enabled by the \link Scheduler \endlink for the statistics.
+ *
+ * Example:
+	* \code
+	void cmdWhoami(CommandArgs& args_p) { txQueue.send("MEAS_STATION\r\n"); }
+	void cmdSetFrequency(CommandArgs& args_p) { args_p.getUInt(0, &measFrequency); }
+
+	constexpr Command_t commandList[] = {
+		command("whoami", cmdWhoami, 0, "name of the device"),
+		command("setFrequency", cmdSetFrequency, 1, "<period [s]>"),
+	};
+	CommandTable<sizeof(commandList) / sizeof(Command_t)> commandTable(commandList);
+
+	//In the main context
+	commandTable.dispatch(line);
+	* \endcode
+ */
+template<size_t Count_p>
+class CommandTable{
+private:
+	static_assert(Count_p * 2 <= COMMANDTABLE_SLOTS, "Too many commands for COMMANDTABLE_SLOTS");
+	static_assert(Count_p < COMMANDTABLE_EMPTY, "Too many commands");
+	static_assert((COMMANDTABLE_SLOTS & (COMMANDTABLE_SLOTS - 1)) == 0, "COMMANDTABLE_SLOTS must be a power of two");
+
+	const Command_t* commands;						///< The command list
+	uint8_t slots[COMMANDTABLE_SLOTS] = {};			///< Index of the command in each slot of the hash table
+	Command_Stats_t stats[Count_p] = {};			///< Statistics of each command
+	uint32_t unknown = 0;							///< Lines with an unknown command
+
+public:
+	/**
+	 * @brief Constructor of the CommandTable class, fills the hash table with linear probing
+	 *
+	 * @param commands_p the command list
+	 */
+	constexpr CommandTable( const Command_t (&commands_p)[Count_p] ) : commands(commands_p)
+	{
+		for( size_t i = 0; i < COMMANDTABLE_SLOTS; i++ )
+		{
+			slots[i] = COMMANDTABLE_EMPTY;
+		}
+
+		for( size_t i = 0; i < Count_p; i++ )
+		{
+			size_t slot = commands_p[i].hash & (COMMANDTABLE_SLOTS - 1);
+			while( slots[slot] != COMMANDTABLE_EMPTY )
+			{
+				slot = (slot + 1) & (COMMANDTABLE_SLOTS - 1);
+			}
+			slots[slot] = i;
+		}
+	}
+
+	/**
+	 * @brief Find a command by its name
+	 *
+	 * @returns Its index in the list, or \link COMMANDTABLE_EMPTY \endlink if there is no such command
+	 */
+	uint8_t find( const char* name_p )
+	{
+		uint32_t hash = commandHash(name_p);
+		size_t slot = hash & (COMMANDTABLE_SLOTS - 1);
+
+		while( slots[slot] != COMMANDTABLE_EMPTY )
+		{
+			const Command_t& candidate = commands[slots[slot]];
+			if( candidate.hash == hash && strcmp(candidate.name, name_p) == 0 )
+			{
+				return slots[slot];
+			}
+			slot = (slot + 1) & (COMMANDTABLE_SLOTS - 1);
+		}
+
+		return COMMANDTABLE_EMPTY;
+	}
+
+	/**
+	 * @brief Parse a line and call the handler of its command
+	 *
+	 * @param line_p the received line, it is split in place
+	 */
+	Command_Result_t dispatch( char* line_p )
+	{
+		while( *line_p == ' ' ) { line_p++; }
+		if( *line_p == '\0' )
+		{
+			return COMMAND_EMPTY;
+		}
+
+		char* rest = line_p;
+		while( *rest != ' ' && *rest != '\0' ) { rest++; }
+		if( *rest == ' ' ) { *rest++ = '\0'; }
+
+		uint8_t index = find(line_p);
+		if( index == COMMANDTABLE_EMPTY )
+		{
+			unknown++;
+			return COMMAND_UNKNOWN;
+		}
+
+		CommandArgs args;
+		args.split(rest);
+
+		if( args.count() < commands[index].minArgs )
+		{
+			stats[index].rejected++;
+			return COMMAND_REJECTED;
+		}
+
+		uint32_t start = DWT->CYCCNT;
+		commands[index].handler(args);
+		uint32_t cycles = DWT->CYCCNT - start;
+
+		stats[index].count++;
+		if( cycles > stats[index].maxCycles ) { stats[index].maxCycles = cycles; }
+
+		return COMMAND_OK;
+	}
+
+	/**
+	 * @brief Get the number of commands
+	 */
+	constexpr size_t size() const
+	{
+		return Count_p;
+	}
+
+	/**
+	 * @brief Get a line of the command list, used for the listing
+	 */
+	const Command_t& getCommand( size_t index_p )
+	{
+		return commands[index_p];
+	}
+
+	/**
+	 * @brief Get the statistics of a command
+	 */
+	const Command_Stats_t& getStats( size_t index_p )
+	{
+		return stats[index_p];
+	}
+
+	/**
+	 * @brief Get the number of lines with an unknown command
+	 */
+	uint32_t getUnknown()
+	{
+		return unknown;
+	}
+};
+
+#endif /* MODULES_COMMANDTABLE_COMMANDTABLE_HPP_ */
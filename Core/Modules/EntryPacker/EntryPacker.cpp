@@ -0,0 +1,93 @@
+/*
+ * EntryPacker.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "EntryPacker.hpp"
+#include <string.h>
+
+EntryPacker::EntryPacker()
+{
+	reset();
+}
+
+void EntryPacker::reset()
+{
+	for(uint8_t i = 0; i < ENTRYPACKER_CHANNELS; i++)
+	{
+		previousData[i] = 0;
+	}
+	previousID = 0;
+	previousDeltaT = 0;
+	first = true;
+}
+
+uint8_t EntryPacker::putVarint( uint32_t value_p, uint8_t* output_p )
+{
+	uint8_t length = 0;
+
+	while( value_p >= 0x80 )
+	{
+		output_p[length++] = (value_p & 0x7F) | 0x80;
+		value_p >>= 7;
+	}
+	output_p[length++] = value_p;
+
+	return length;
+}
+
+uint8_t EntryPacker::pack( const uint8_t* entry_p, uint8_t* output_p )
+{
+	uint8_t measID = entry_p[0];
+	uint16_t deltaT;
+	uint32_t measData;
+	memcpy(&deltaT, entry_p + sizeof(uint8_t), sizeof(deltaT));
+	memcpy(&measData, entry_p + sizeof(uint8_t) + sizeof(uint16_t), sizeof(measData));
+
+	//Zigzag: the small differences of either sign become small unsigned numbers
+	uint32_t* previous = &previousData[measID & (ENTRYPACKER_CHANNELS - 1)];
+	int32_t difference = (int32_t)(measData - *previous);
+	uint32_t zigzag = ((uint32_t)difference << 1) ^ (uint32_t)(difference >> 31);
+
+	uint8_t flag = 0;
+	uint8_t length = 1;
+
+	if( !first && measID == previousID )
+	{
+		flag |= 0x01;
+	}
+	else
+	{
+		output_p[length++] = measID;
+	}
+
+	if( !first && deltaT == previousDeltaT )
+	{
+		flag |= 0x02;
+	}
+	else
+	{
+		length += putVarint(deltaT, output_p + length);
+	}
+
+	if( zigzag < ENTRYPACKER_ESCAPE )
+	{
+		flag |= zigzag << 2;
+	}
+	else
+	{
+		flag |= ENTRYPACKER_ESCAPE << 2;
+		length += putVarint(zigzag, output_p + length);
+	}
+
+	output_p[0] = flag;
+
+	*previous = measData;
+	previousID = measID;
+	previousDeltaT = deltaT;
+	first = false;
+
+	return length;
+}
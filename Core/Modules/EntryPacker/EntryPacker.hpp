@@ -0,0 +1,82 @@
+/**
+ * @file EntryPacker.hpp
+ * @brief Lossless compression of the stored entries for the readout.
+ *
+ * @details Consecutive entries of a log differ little: the measID and the deltaT usually repeat and the temperature changes slowly.
+ * Each entry is packed as a flag byte and the fields that can not be derived from the previous entries:
+ * - flag bit 0: the measID is the same as in the previous entry, else the measID byte follows
+ * - flag bit 1: the deltaT is the same as in the previous entry, else the deltaT follows as a varint
+ * - flag bits 7..2: the zigzag encoded difference of measData from the previous measData of the same channel if less than 63,
+ *   63 means the difference follows as a varint
+ *
+ * The varints are little-endian base 128, the highest bit of a byte tells that another one follows. The previous measData is kept
+ * for \link ENTRYPACKER_CHANNELS \endlink channels selected by the low bits of the measID, with no other state and no heap.
+ * The packer is reset at the start of every frame, so every frame can be decoded by itself.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_ENTRYPACKER_ENTRYPACKER_HPP_
+#define MODULES_ENTRYPACKER_ENTRYPACKER_HPP_
+
+#include <stdint.h>
+
+/// Number of channels whose previous measData is kept (must be a power of two)
+#define ENTRYPACKER_CHANNELS 16
+
+/// Longest packed entry: flag, measID, deltaT (3 byte varint) and measData difference (5 byte varint)
+#define ENTRYPACKER_MAX_PACKED 10
+
+/// The inline difference that means a varint follows
+#define ENTRYPACKER_ESCAPE 63
+
+/**
+ * @brief Class of the packer
+ *
+ * Example:
+	* \code
+	EntryPacker packer;
+	uint8_t packed[128];
+	uint16_t length = 0;
+
+	packer.reset();
+	while(length + ENTRYPACKER_MAX_PACKED <= sizeof(packed) && next entry)
+	{
+		length += packer.pack(entry, packed + length);
+	}
+	* \endcode
+ */
+class EntryPacker{
+private:
+	uint32_t previousData[ENTRYPACKER_CHANNELS];	///< The last measData of each channel
+	uint8_t previousID;								///< measID of the previous entry
+	uint16_t previousDeltaT;						///< deltaT of the previous entry
+	bool first;										///< No entry has been packed since the reset
+
+	/**
+	 * @brief Write a varint
+	 *
+	 * @returns The number of bytes written
+	 */
+	static uint8_t putVarint( uint32_t value_p, uint8_t* output_p );
+
+public:
+	EntryPacker();
+
+	/**
+	 * @brief Forget the previous entries, called at the start of a frame
+	 */
+	void reset();
+
+	/**
+	 * @brief Pack an entry
+	 *
+	 * @param entry_p the entry as stored (measID, deltaT, measData, little-endian)
+	 * @param output_p at least \link ENTRYPACKER_MAX_PACKED \endlink bytes
+	 *
+	 * @returns The number of bytes written
+	 */
+	uint8_t pack( const uint8_t* entry_p, uint8_t* output_p );
+};
+
+#endif /* MODULES_ENTRYPACKER_ENTRYPACKER_HPP_ */
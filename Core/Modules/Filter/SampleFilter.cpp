@@ -0,0 +1,186 @@
+/*
+ * SampleFilter.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "SampleFilter.hpp"
+
+SampleFilter::SampleFilter( SampleFilterType_t type_p, uint8_t param_p )
+{
+	configure(type_p, param_p);
+}
+
+void SampleFilter::configure( SampleFilterType_t type_p, uint8_t param_p )
+{
+	type = type_p;
+
+	if( param_p == 0 ) { param_p = 1; }
+
+	if( type_p == FILTER_IIR )
+	{
+		if( param_p > SAMPLEFILTER_MAX_IIR_SHIFT ) { param_p = SAMPLEFILTER_MAX_IIR_SHIFT; }
+	}
+	else
+	{
+		if( param_p > SAMPLEFILTER_MAX_WINDOW ) { param_p = SAMPLEFILTER_MAX_WINDOW; }
+	}
+
+	param = param_p;
+
+	reset();
+}
+
+void SampleFilter::reset()
+{
+	windowPos = 0;
+	windowFill = 0;
+	windowSum = 0;
+	iirState = 0;
+	periodSum = 0;
+	periodCount = 0;
+	ringTail = ringHead; //drop the waiting samples
+}
+
+bool SampleFilter::push( uint16_t sample_p )
+{
+	uint16_t head = ringHead;
+	uint16_t next = (head + 1) & (SAMPLEFILTER_RING_SIZE - 1);
+
+	if( next == ringTail )
+	{
+		overflowCount++;
+		return false;
+	}
+
+	ring[head] = sample_p;
+	ringHead = next;
+
+	return true;
+}
+
+void SampleFilter::process()
+{
+	uint16_t tail = ringTail;
+
+	while( tail != ringHead )
+	{
+		update( ring[tail] );
+		tail = (tail + 1) & (SAMPLEFILTER_RING_SIZE - 1);
+		ringTail = tail;
+	}
+}
+
+void SampleFilter::updateSorted( uint16_t old_p, uint16_t new_p, bool full_p )
+{
+	uint8_t n = windowFill;
+
+	//Remove the oldest sample, if the window is full
+	if( full_p )
+	{
+		uint8_t i = 0;
+		while( i < n-1 && sorted[i] != old_p ) { i++; }
+		for( ; i < n-1; i++ ) { sorted[i] = sorted[i+1]; }
+		n--;
+	}
+
+	//Insert the new one to its place
+	uint8_t j = n;
+	while( j > 0 && sorted[j-1] > new_p )
+	{
+		sorted[j] = sorted[j-1];
+		j--;
+	}
+	sorted[j] = new_p;
+}
+
+void SampleFilter::update( uint16_t sample_p )
+{
+	lastSample = sample_p;
+
+	periodSum += sample_p;
+	periodCount++;
+
+	switch (type)
+	{
+		case FILTER_MOVING_AVERAGE:
+		case FILTER_MEDIAN:
+		{
+			bool full = (windowFill == param);
+			uint16_t oldest = window[windowPos];
+
+			if( type == FILTER_MEDIAN )
+			{
+				updateSorted(oldest, sample_p, full);
+			}
+
+			if( full ) { windowSum -= oldest; }
+			else { windowFill++; }
+
+			windowSum += sample_p;
+			window[windowPos] = sample_p;
+			windowPos = (windowPos + 1) % param;
+			break;
+		}
+		case FILTER_IIR:
+		{
+			if( windowFill == 0 ) //The first sample initializes the state
+			{
+				iirState = (int32_t)sample_p << 8;
+				windowFill = 1;
+			}
+			else
+			{
+				iirState += ( ((int32_t)sample_p << 8) - iirState ) >> param;
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+bool SampleFilter::read( uint16_t* value_p )
+{
+	process();
+
+	if( periodCount == 0 )
+	{
+		return false;
+	}
+
+	switch (type)
+	{
+		case FILTER_AVERAGE:
+			*value_p = (uint16_t)( (periodSum + periodCount/2) / periodCount );
+			break;
+		case FILTER_MOVING_AVERAGE:
+			*value_p = (windowSum + windowFill/2) / windowFill;
+			break;
+		case FILTER_MEDIAN:
+			*value_p = sorted[windowFill/2];
+			break;
+		case FILTER_IIR:
+			*value_p = (iirState + 128) >> 8;
+			break;
+		default:
+			*value_p = lastSample;
+			break;
+	}
+
+	periodSum = 0;
+	periodCount = 0;
+
+	return true;
+}
+
+SampleFilterType_t SampleFilter::getType()
+{
+	return type;
+}
+
+uint32_t SampleFilter::getOverflowCount()
+{
+	return overflowCount;
+}
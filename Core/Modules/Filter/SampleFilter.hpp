@@ -0,0 +1,154 @@
+/**
+ * @file SampleFilter.hpp
+ * @brief Streaming digital filter for raw sensor samples.
+ *
+ * @details The samples are pushed into a fixed ring buffer (e.g. on every DRDY event of a MAX31865 in continuous mode),
+ * and fed through the selected filter stage. Every filter works on integers and needs a fixed amount of time per sample,
+ * so instead of throwing away the conversions between two logged values, all of them are used to lower the noise.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_FILTER_SAMPLEFILTER_HPP_
+#define MODULES_FILTER_SAMPLEFILTER_HPP_
+
+#include <stdint.h>
+
+/// Size of the ring buffer between the producer and the filter stage (must be a power of two)
+#define SAMPLEFILTER_RING_SIZE 64
+
+/// Largest window of the moving average and the median filter
+#define SAMPLEFILTER_MAX_WINDOW 15
+
+/// Largest shift (smallest coefficient = 2^-shift) of the IIR filter
+#define SAMPLEFILTER_MAX_IIR_SHIFT 8
+
+/**
+ * @enum SampleFilterType_t
+ * @brief The selectable filter stages.
+ */
+typedef enum{
+	FILTER_NONE = 0,			/*!< The last sample is used */
+	FILTER_AVERAGE,				/*!< Average of every sample since the last readout (oversampling) */
+	FILTER_MOVING_AVERAGE,		/*!< Average of the last N samples */
+	FILTER_MEDIAN,				/*!< Median of the last N samples, removes spikes */
+	FILTER_IIR,					/*!< First-order IIR low-pass: y += (x - y) / 2^N */
+} SampleFilterType_t;
+
+/**
+ * @brief Class for filtering a stream of samples
+ *
+ * \link SampleFilter::push push \endlink can be called from an interrupt, everything else must be called from the main context.
+ *
+ * Example:
+	* \code
+	SampleFilter myFilter(FILTER_MEDIAN, 5);
+	⋮
+	//On every new conversion
+	myFilter.push(rawSample);
+	⋮
+	//When a value is logged
+	uint16_t filtered;
+	if( myFilter.read(&filtered) )
+	{
+		⋮
+	}
+ * \endcode
+ */
+class SampleFilter{
+private:
+	/**
+	 * @brief Ring buffer of the samples not yet processed
+	 */
+	volatile uint16_t ring[SAMPLEFILTER_RING_SIZE];
+
+	volatile uint16_t ringHead = 0;	///< Written by the producer
+	volatile uint16_t ringTail = 0;	///< Written by the filter stage
+
+	uint32_t overflowCount = 0;		///< Number of samples lost because the ring was full
+
+	SampleFilterType_t type;		///< Selected filter stage
+	uint8_t param;					///< Window of the moving average / median, shift of the IIR
+
+	uint16_t window[SAMPLEFILTER_MAX_WINDOW];	///< Last N samples in arrival order
+	uint16_t sorted[SAMPLEFILTER_MAX_WINDOW];	///< Last N samples in increasing order (median)
+	uint8_t windowPos = 0;						///< Position of the oldest sample in the window
+	uint8_t windowFill = 0;						///< Number of valid samples in the window
+	uint32_t windowSum = 0;						///< Sum of the window (moving average)
+
+	int32_t iirState = 0;			///< State of the IIR filter, with 8 fractional bits
+	uint64_t periodSum = 0;			///< Sum of the samples since the last readout
+	uint32_t periodCount = 0;		///< Number of samples since the last readout, a long period at full rate does not fit into 16 bits
+	uint16_t lastSample = 0;		///< The last processed sample
+
+	/**
+	 * @brief Feed one sample through the filter stage
+	 */
+	void update( uint16_t sample_p );
+
+	/**
+	 * @brief Put a new sample into the sorted window, replacing the oldest one
+	 */
+	void updateSorted( uint16_t old_p, uint16_t new_p, bool full_p );
+
+public:
+	/**
+	 * @brief Constructor for the SampleFilter class
+	 *
+	 * @param type_p the filter stage to be used
+	 * @param param_p window size (moving average, median) or shift (IIR)
+	 */
+	SampleFilter( SampleFilterType_t type_p = FILTER_AVERAGE, uint8_t param_p = 8 );
+
+	/**
+	 * @brief Select the filter stage, clears every stored sample
+	 *
+	 * @param type_p the filter stage to be used
+	 * @param param_p window size (moving average, median: 1 - \link SAMPLEFILTER_MAX_WINDOW \endlink) or shift (IIR: 1 - \link SAMPLEFILTER_MAX_IIR_SHIFT \endlink), limited to the valid range
+	 */
+	void configure( SampleFilterType_t type_p, uint8_t param_p );
+
+	/**
+	 * @brief Put a new sample into the ring buffer
+	 *
+	 * Safe to call from an interrupt, as long as there is only one producer.
+	 *
+	 * @param sample_p the new sample
+	 *
+	 * @returns False if the ring was full and the sample was lost
+	 */
+	bool push( uint16_t sample_p );
+
+	/**
+	 * @brief Feed every sample waiting in the ring buffer through the filter stage
+	 */
+	void process();
+
+	/**
+	 * @brief Get the filtered value
+	 *
+	 * The waiting samples are processed first. With \link FILTER_AVERAGE \endlink the average is restarted.
+	 *
+	 * @param value_p where the filtered value is stored
+	 *
+	 * @returns False if there was no new sample since the last readout
+	 */
+	bool read( uint16_t* value_p );
+
+	/**
+	 * @brief Clear every stored sample
+	 */
+	void reset();
+
+	/**
+	 * @brief Get the selected filter stage
+	 */
+	SampleFilterType_t getType();
+
+	/**
+	 * @brief Get the number of samples lost because the ring was full
+	 */
+	uint32_t getOverflowCount();
+};
+
+#endif /* MODULES_FILTER_SAMPLEFILTER_HPP_ */
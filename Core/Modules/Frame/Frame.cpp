@@ -0,0 +1,77 @@
+/*
+ * Frame.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "Frame.hpp"
+#include <string.h>
+
+uint16_t crc16( const uint8_t* data_p, uint16_t size_p, uint16_t crc_p )
+{
+	for(uint16_t i = 0; i < size_p; i++)
+	{
+		crc_p ^= (uint16_t)data_p[i] << 8;
+		for(uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc_p = (crc_p & 0x8000) ? (crc_p << 1) ^ 0x1021 : (crc_p << 1);
+		}
+	}
+	return crc_p;
+}
+
+uint16_t cobsEncode( const uint8_t* input_p, uint16_t size_p, uint8_t* output_p )
+{
+	uint16_t codePosition = 0;	//Where the length of the current block goes
+	uint16_t position = 1;
+	uint8_t code = 1;
+
+	for(uint16_t i = 0; i < size_p; i++)
+	{
+		if( input_p[i] == 0 )
+		{
+			output_p[codePosition] = code;
+			codePosition = position++;
+			code = 1;
+			continue;
+		}
+
+		output_p[position++] = input_p[i];
+		code++;
+
+		//A full block has no zero after it
+		if( code == 0xFF )
+		{
+			output_p[codePosition] = code;
+			codePosition = position++;
+			code = 1;
+		}
+	}
+
+	output_p[codePosition] = code;
+	output_p[position++] = 0;
+
+	return position;
+}
+
+uint16_t buildFrame( uint8_t type_p, uint16_t sequence_p, const uint8_t* payload_p, uint16_t size_p, uint8_t* output_p )
+{
+	if( size_p > FRAME_MAX_PAYLOAD )
+	{
+		return 0;
+	}
+
+	uint8_t frame[FRAME_MAX_PAYLOAD + FRAME_OVERHEAD];
+
+	frame[0] = type_p;
+	frame[1] = sequence_p & 0xFF;
+	frame[2] = sequence_p >> 8;
+	memcpy(&frame[3], payload_p, size_p);
+
+	uint16_t crc = crc16(frame, size_p + 3);
+	frame[size_p + 3] = crc & 0xFF;
+	frame[size_p + 4] = crc >> 8;
+
+	return cobsEncode(frame, size_p + FRAME_OVERHEAD, output_p);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file Frame.hpp
+ * @brief Binary frames of the bulk data transfer.
+ *
+ * @details A frame is: type (1 byte), sequence number (2 bytes), payload, CRC-16 of the previous bytes (2 bytes),
+ * the numbers are little-endian. The frame is COBS encoded, so it contains no zero byte, and a zero byte closes it.
+ * The receiver can find the start of the next frame after any error, and a corrupted frame is caught by the CRC,
+ * a lost one by the sequence number.
+ *
+ * The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF), in python: binascii.crc_hqx(data, 0xFFFF).
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_FRAME_FRAME_HPP_
+#define MODULES_FRAME_FRAME_HPP_
+
+#include <stdint.h>
+
+/// Longest payload of a frame
+#define FRAME_MAX_PAYLOAD 128
+
+/// Bytes of a frame besides the payload: type, sequence number and CRC
+#define FRAME_OVERHEAD 5
+
+/// Longest encoded frame: COBS adds one byte per 254 bytes and the first code byte, and the closing zero
+#define FRAME_MAX_ENCODED ( FRAME_MAX_PAYLOAD + FRAME_OVERHEAD + (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD) / 254 + 2 )
+
+/**
+ * @typedef Frame_Type_t
+ * @brief Type of a frame, the first byte
+ */
+typedef enum{
+	FRAME_HEADER	= 0x01,		//Payload: timestamp (8 bytes), number of entries (2 bytes), length of an entry (1 byte), index of the first entry sent (2 bytes)
+	FRAME_ENTRIES	= 0x02,		//Payload: index of the first entry (2 bytes), the entries as stored
+	FRAME_END		= 0x03,		//Payload: index of the next entry (2 bytes)
+	FRAME_PACKED	= 0x04,		//Payload: index of the first entry (2 bytes), number of entries (1 byte), the entries packed by EntryPacker
+} Frame_Type_t;
+
+/**
+ * @brief Calculate the CRC-16/CCITT-FALSE of a block
+ *
+ * @param crc_p the CRC of the previous blocks, to continue it
+ */
+uint16_t crc16( const uint8_t* data_p, uint16_t size_p, uint16_t crc_p = 0xFFFF );
+
+/**
+ * @brief COBS encode a block and close it with a zero byte
+ *
+ * @param output_p at least size_p + size_p/254 + 2 bytes
+ *
+ * @returns The number of bytes written, the closing zero included
+ */
+uint16_t cobsEncode( const uint8_t* input_p, uint16_t size_p, uint8_t* output_p );
+
+/**
+ * @brief Build an encoded frame
+ *
+ * @param type_p the \link Frame_Type_t \endlink
+ * @param sequence_p the sequence number
+ * @param payload_p the payload, at most \link FRAME_MAX_PAYLOAD \endlink bytes
+ * @param output_p at least \link FRAME_MAX_ENCODED \endlink bytes
+ *
+ * @returns The number of bytes written, 0 if the payload is too long
+ */
+uint16_t buildFrame( uint8_t type_p, uint16_t sequence_p, const uint8_t* payload_p, uint16_t size_p, uint8_t* output_p );
+
+#endif /* MODULES_FRAME_FRAME_HPP_ */
@@ -0,0 +1,78 @@
+/*
+ * LineQueue.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "LineQueue.hpp"
+
+bool LineQueue::putByte( uint8_t byte_p )
+{
+	if( byte_p == '\n' )
+	{
+		return false;
+	}
+
+	uint16_t used = (head - tail) & (LINEQUEUE_SIZE - 1);
+	uint16_t space = LINEQUEUE_SIZE - 1 - used;
+	bool terminator = ( byte_p == LINEQUEUE_TERMINATOR );
+
+	//The last free place is only given to a terminator
+	if( space == 0 || ( space == 1 && !terminator ) )
+	{
+		dropped++;
+		return false;
+	}
+
+	ring[head] = byte_p;
+	head = (head + 1) & (LINEQUEUE_SIZE - 1);
+
+	if( terminator )
+	{
+		completed++;
+	}
+
+	return terminator;
+}
+
+bool LineQueue::getLine( char* buffer_p, uint16_t size_p )
+{
+	if( !hasLine() )
+	{
+		return false;
+	}
+
+	uint16_t len = 0;
+
+	while( true )
+	{
+		uint8_t byte = ring[tail];
+		tail = (tail + 1) & (LINEQUEUE_SIZE - 1);
+
+		if( byte == LINEQUEUE_TERMINATOR )
+		{
+			break;
+		}
+
+		if( len + 1 < size_p )
+		{
+			buffer_p[len++] = byte;
+		}
+	}
+
+	buffer_p[len] = '\0';
+	taken++;
+
+	return true;
+}
+
+bool LineQueue::hasLine()
+{
+	return completed != taken;
+}
+
+uint32_t LineQueue::getDropped()
+{
+	return dropped;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file LineQueue.hpp
+ * @brief Lock-free queue of received text lines.
+ *
+ * @details The receive interrupt only puts the bytes into a ring buffer and counts the completed lines,
+ * the lines are taken out and parsed in the main context. One side writes the head, the other the tail,
+ * so no interrupt has to be disabled.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_LINEQUEUE_LINEQUEUE_HPP_
+#define MODULES_LINEQUEUE_LINEQUEUE_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Size of the ring buffer in bytes, several lines fit into it (must be a power of two)
+#define LINEQUEUE_SIZE 256
+
+/// The byte that ends a line
+#define LINEQUEUE_TERMINATOR '\r'
+
+/**
+ * @brief Class of the line queue
+ *
+ * Example:
+	* \code
+	LineQueue commandQueue;
+
+	//In the receive interrupt
+	if( commandQueue.putByte(rxByte) )
+	{
+		//a line has been completed
+	}
+
+	//In the main context
+	char line[100];
+	while( commandQueue.getLine(line, sizeof(line)) )
+	{
+		parse(line);
+	}
+ * \endcode
+ */
+class LineQueue{
+private:
+	uint8_t ring[LINEQUEUE_SIZE];	///< The received bytes, the lines are separated by \link LINEQUEUE_TERMINATOR \endlink
+	volatile uint16_t head = 0;		///< Written by the producer, where the next byte is put
+	volatile uint16_t tail = 0;		///< Written by the consumer, the next byte to take
+	volatile uint16_t completed = 0;	///< Lines put by the producer
+	uint16_t taken = 0;				///< Lines taken by the consumer
+	volatile uint32_t dropped = 0;	///< Bytes lost because the ring was full
+
+public:
+	/**
+	 * @brief Put a received byte into the queue, called from the receive interrupt
+	 *
+	 * '\n' is ignored, so both "\r" and "\r\n" end a line. If the ring is full the byte is dropped,
+	 * but the last free place is kept for the terminator, so the lines stay separated.
+	 *
+	 * @returns True if the byte completed a line
+	 */
+	bool putByte( uint8_t byte_p );
+
+	/**
+	 * @brief Take the oldest completed line out of the queue
+	 *
+	 * @param buffer_p where the line is copied, it is terminated with '\0'
+	 * @param size_p size of the buffer, the rest of a longer line is dropped
+	 *
+	 * @returns False if there is no completed line
+	 */
+	bool getLine( char* buffer_p, uint16_t size_p );
+
+	/**
+	 * @brief Check if a completed line is waiting
+	 */
+	bool hasLine();
+
+	/**
+	 * @brief Get the number of bytes lost because the ring was full
+	 */
+	uint32_t getDropped();
+};
+
+#endif /* MODULES_LINEQUEUE_LINEQUEUE_HPP_ */
@@ -7,23 +7,117 @@
 
 #include "MAX31865.hpp"
 
+void MAX31865::updateConversion()
+{
+	//R = code * R_REF / 2^15, T = (R - R0) / alpha, alpha scales with R0 (0.385 ohm/C for a PT100, 3.85 ohm/C for a PT1000)
+	float alpha = RTD_ALPHA_PT100 * r0 / 100.0;
+	float slope = rRef * 1000.0 / (32768.0 * alpha);	//[mC/code]
+	float intercept = -(r0 * 1000.0) / alpha;			//[mC]
+
+	//The calibration is applied on the nominal temperature: T = gain * T_nominal + offset
+	float gain = (float)calibration.gain / MAX31865_CAL_UNITY_GAIN;
+
+	convSlope = (int32_t)(slope * gain * 65536.0 + 0.5);
+	convIntercept = (int32_t)(intercept * gain) + calibration.offset;
+}
+
+int32_t MAX31865::milliCelsiusFromRTD(uint16_t rtdValue_p)
+{
+	//15 bit RTD value, the fault bit is dropped
+	return (int32_t)( ( (int64_t)(rtdValue_p >> 1) * convSlope ) >> 16 ) + convIntercept;
+}
+
 float MAX31865::tempFromRTD(uint16_t rtdValue_p)
 {
-    float resistance = (rtdValue_p >> 1) * R_REF / 32768.0; // 430.0 value of reference resistor
-    float temperature = (resistance - r0) / 0.385; // 0.385 is the temperature coefficient
-    return temperature;
+	return milliCelsiusFromRTD(rtdValue_p) * 0.001f;
 }
 
 uint16_t MAX31865::RTDFromTemp(float tempValue_p)
 {
-    float resistance = tempValue_p * 0.385 + r0;
-    uint16_t rtdValue = static_cast<uint16_t>((resistance / R_REF) * 32768.0);
+	int64_t rtdValue = ( (int64_t)( (int32_t)(tempValue_p * 1000) - convIntercept ) << 16 ) / convSlope;
+
+	if( rtdValue < 0 ) { rtdValue = 0; }
+	if( rtdValue > 0x7FFF ) { rtdValue = 0x7FFF; }
+
+	//15 bit RTD value, LSB is do not care
+	return (uint16_t)(rtdValue << 1);
+}
+
+void MAX31865::setReferenceResistor(float rRef_p)
+{
+	rRef = rRef_p;
+	updateConversion();
+}
+
+float MAX31865::getReferenceResistor()
+{
+	return rRef;
+}
+
+void MAX31865::setCalibration(MAX31865_Calibration_t calibration_p)
+{
+	if( calibration_p.gain <= 0 )
+	{
+		calibration_p.gain = MAX31865_CAL_UNITY_GAIN;
+		calibration_p.offset = 0;
+	}
+
+	calibration = calibration_p;
+	updateConversion();
+}
+
+MAX31865_Calibration_t MAX31865::getCalibration()
+{
+	return calibration;
+}
+
+bool MAX31865::calibrateTwoPoint(uint16_t rtd1_p, float reference1_p, uint16_t rtd2_p, float reference2_p)
+{
+	//The nominal (uncalibrated) temperatures of the two points
+	float alpha = RTD_ALPHA_PT100 * r0 / 100.0;
+	float nominal1 = ( (rtd1_p >> 1) * rRef / 32768.0 - r0 ) / alpha;
+	float nominal2 = ( (rtd2_p >> 1) * rRef / 32768.0 - r0 ) / alpha;
+
+	float nominalSpan = nominal2 - nominal1;
+	float referenceSpan = reference2_p - reference1_p;
+
+	if( nominalSpan < MAX31865_CAL_MIN_SPAN && nominalSpan > -MAX31865_CAL_MIN_SPAN )
+	{
+		return false;
+	}
+
+	float gain = referenceSpan / nominalSpan;
+
+	//A probe that is off by this much is broken, not uncalibrated
+	if( gain < 0.5 || gain > 2.0 )
+	{
+		return false;
+	}
 
-    //15 bit RTD value, LSB is do not care
-    return rtdValue << 1;
+	MAX31865_Calibration_t newCalibration;
+	newCalibration.gain = (int32_t)(gain * MAX31865_CAL_UNITY_GAIN + 0.5);
+	newCalibration.offset = (int32_t)( (reference1_p - gain * nominal1) * 1000 );
+
+	setCalibration(newCalibration);
+
+	return true;
+}
+
+uint16_t MAX31865::decodeFaultStatus(uint8_t faultValue_p)
+{
+	uint16_t errors = 0;
+
+	if( ( faultValue_p & FAULT_STATUS_D7 ) != 0 ) { errors += HighThrehsold; }
+	if( ( faultValue_p & FAULT_STATUS_D6 ) != 0 ) { errors += LowThrehsold; }
+	if( ( faultValue_p & FAULT_STATUS_D5 ) != 0 ) { errors += VREFINneg_greater_0p85_x_VBIAS; }
+	if( ( faultValue_p & FAULT_STATUS_D4 ) != 0 ) { errors += VREFINneg_smaller_0p85_x_VBIAS_Force_Open; }
+	if( ( faultValue_p & FAULT_STATUS_D3 ) != 0 ) { errors += RTDINneg_smaller_0p85_x_VBIAS_Force_Open; }
+	if( ( faultValue_p & FAULT_STATUS_D2 ) != 0 ) { errors += OV_or_UV; }
+
+	return errors;
 }
 
-MAX31865::MAX31865( SPI_HandleTypeDef *hspi_p, GPIO* csPin_p , GPIO* DRDYpin_p, RTD_type_t RTD_type_p )
+MAX31865::MAX31865( SPI_HandleTypeDef *hspi_p, GPIO* csPin_p , GPIO* DRDYpin_p, RTD_type_t RTD_type_p, float rRef_p )
 {
 	hspi = hspi_p;
 	csPin = csPin_p;
@@ -36,28 +130,25 @@ MAX31865::MAX31865( SPI_HandleTypeDef *hspi_p, GPIO* csPin_p , GPIO* DRDYpin_p,
 	{
 		r0 = 1000;
 	}
+	rRef = rRef_p;
+	updateConversion();
+	setBiasSettling();
 }
 
 HAL_StatusTypeDef MAX31865::init( MAX31865_FilterSetting_t filterSetting_p )
 {
-	HAL_StatusTypeDef stat;
-
 	//First wake up the sensor by reading a register (it will return junk)
 	uint8_t buff[1];
-	readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, buff, 1);
+	readNFromAddres(MAX31865_ConfigReg::address, buff, 1);
 
-	//Turn the bias voltage on and set the filter
-	uint8_t configValue = 0;
+	filterSetting = filterSetting_p;
 
-	configValue |= MAX31865_CONFIG_VBIAS_ON;
-
-	//If 50Hz is set, set the bit, a bit value of 0 would set the 60Hz filter
-	if ( filterSetting_p == MAX31865_FILTER_50HZ ) {configValue |= MAX31865_CONFIG_REG_FILTER_50Hz;}
+	//Turn the bias voltage on and set the filter, a bit value of 0 would set the 60Hz filter
+	uint8_t configValue = MAX31865_Filter50Hz::set(0, filterSetting_p == MAX31865_FILTER_50HZ);
+	configValue = FieldUpdate<MAX31865_VBias::is<1>>::apply(configValue);
 
 	//Write the config register
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-
-	return stat;
+	return writeConfig(configValue);
 }
 
 HAL_StatusTypeDef MAX31865::readNFromAddres( uint8_t addr_p, uint8_t* rBuff_p, uint32_t dataSize_p )
@@ -74,12 +165,28 @@ HAL_StatusTypeDef MAX31865::readNFromAddres( uint8_t addr_p, uint8_t* rBuff_p, u
 	return stat;
 }
 
+HAL_StatusTypeDef MAX31865::writeConfig( uint8_t configValue_p )
+{
+	HAL_StatusTypeDef stat = writeRegister<MAX31865_ConfigReg>(configValue_p);
+
+	//The self-clearing bits are not kept, so they are not written again by the next update
+	configShadow = configValue_p & ~MAX31865_CONFIG_SELF_CLEARING;
+
+	return stat;
+}
+
 HAL_StatusTypeDef MAX31865::writeNFromAddres( uint8_t addr_p, uint8_t* wBuff_p, uint32_t dataSize_p )
 {
 	HAL_StatusTypeDef stat;
 
-	//The device has a maximum of 4 consiquential writable registers
-	uint8_t msgBuff[4] = {0, 0, 0, 0};
+	//The device has a maximum of 4 consiquential writable registers, the address byte comes before them
+	const uint32_t maxDataSize = 4;
+	uint8_t msgBuff[1 + maxDataSize] = {0, 0, 0, 0, 0};
+
+	if( dataSize_p > maxDataSize )
+	{
+		return HAL_ERROR;
+	}
 
 	//Construct the package
 	msgBuff[0] = addr_p | MAX31865_WRITE_OFFSET_MASK;
@@ -108,14 +215,21 @@ void MAX31865::setUpperThreshold(float thr_p)
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
 
-	uint16_t thrRTDValue = RTDFromTemp(thr_p);
+	stat = writeRegister<MAX31865_HighFaultReg>(RTDFromTemp(thr_p));
 
-	uint8_t msgBuff[2];
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += SPI_error;
+		errorHandler(this, errors);
+	}
+}
 
-	msgBuff[0] = thrRTDValue >> 8;	//MSB
-	msgBuff[1] = thrRTDValue; 		//LSB
+void MAX31865::setLowerThreshold(float thr_p)
+{
+	HAL_StatusTypeDef stat;
+	uint16_t errors = 0;
 
-	stat = writeNFromAddres(MAX31865_HIGH_FAULT_MSB_REG_ADDRESS, (uint8_t*) msgBuff, sizeof(msgBuff));
+	stat = writeRegister<MAX31865_LowFaultReg>(RTDFromTemp(thr_p));
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -124,36 +238,88 @@ void MAX31865::setUpperThreshold(float thr_p)
 	}
 }
 
-void MAX31865::setLowerThreshold(float thr_p)
+void MAX31865::writeThresholds( uint16_t high_p, uint16_t low_p )
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
 
-	uint16_t thrRTDValue = RTDFromTemp(thr_p);
+	//The High and Low Fault Threshold registers follow each other, so they are written in one transaction
+	static_assert( MAX31865_LowFaultReg::address == MAX31865_HighFaultReg::address + MAX31865_HighFaultReg::width, "The threshold registers are not contiguous" );
 
-	uint8_t msgBuff[2];
+	uint8_t msgBuff[MAX31865_HighFaultReg::width + MAX31865_LowFaultReg::width];
 
-	msgBuff[0] = thrRTDValue >> 8;	//MSB
-	msgBuff[1] = thrRTDValue; 		//LSB
+	MAX31865_HighFaultReg::toBytes(high_p, msgBuff);
+	MAX31865_LowFaultReg::toBytes(low_p, msgBuff + MAX31865_HighFaultReg::width);
 
-	stat = writeNFromAddres(MAX31865_LOW_FAULT_MSB_REG_ADDRESS, (uint8_t*) msgBuff, sizeof(msgBuff));
+	stat = writeNFromAddres(MAX31865_HighFaultReg::address, (uint8_t*) msgBuff, sizeof(msgBuff));
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
 		errors += SPI_error;
 		errorHandler(this, errors);
 	}
+
+	clearFaults();
+	thresholdTripCarried = false;
 }
 
-float MAX31865::getUpperThreshold()
+void MAX31865::setThresholdWindow(float center_p, float deadband_p)
+{
+	writeThresholds(RTDFromTemp(center_p + deadband_p), RTDFromTemp(center_p - deadband_p));
+}
+
+void MAX31865::clearThresholdWindow()
+{
+	writeThresholds(0xFFFF, 0x0000);
+}
+
+bool MAX31865::thresholdTripped()
+{
+	bool tripped = thresholdTripCarried || ( readFaultStatus() & (HighThrehsold | LowThrehsold) ) != 0;
+	thresholdTripCarried = false;
+
+	return tripped;
+}
+
+uint16_t MAX31865::readFaultStatus()
+{
+	HAL_StatusTypeDef stat;
+	uint16_t errors = 0;
+	uint8_t faultValue = 0;
+
+	stat = readRegister<MAX31865_FaultStatusReg>(&faultValue);
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += SPI_error;
+		errorHandler(this, errors);
+	}
+
+	return decodeFaultStatus(faultValue);
+}
+
+void MAX31865::clearFaults()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t RTDbuff[2] = {0, 0};
 
-	stat = readNFromAddres(MAX31865_HIGH_FAULT_MSB_REG_ADDRESS, RTDbuff, 2);
+	//A single write from the shadow register, a fault detection cycle is not restarted as D3:D2 are not kept in it
+	stat = updateConfig<MAX31865_FaultClear::is<1>>();
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += SPI_error;
+		errorHandler(this, errors);
+	}
+}
 
-	uint16_t RTD = (RTDbuff[0] << 8) | RTDbuff[1]; // Combine
+float MAX31865::getUpperThreshold()
+{
+	HAL_StatusTypeDef stat;
+	uint16_t errors = 0;
+	uint16_t RTD = 0;
+
+	stat = readRegister<MAX31865_HighFaultReg>(&RTD);
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -168,11 +334,9 @@ float MAX31865::getLowerThreshold()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t RTDbuff[2] = {0, 0};
-
-	stat = readNFromAddres(MAX31865_LOW_FAULT_MSB_REG_ADDRESS, RTDbuff, 2);
+	uint16_t RTD = 0;
 
-	uint16_t RTD = (RTDbuff[0] << 8) | RTDbuff[1]; // Combine
+	stat = readRegister<MAX31865_LowFaultReg>(&RTD);
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -189,15 +353,8 @@ float MAX31865::singleMeas()
 	uint16_t errors = 0;
 	uint8_t configValue;
 
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-
-	//new config value
-	configValue |= MAX31865_CONFIG_ONE_SHOT;
-
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-
+	//set the one-shot bit
+	stat = updateConfig<MAX31865_OneShot::is<1>>();
 
 	//wait for the measuerement
 	if(DRDYpin != NULL)
@@ -206,10 +363,10 @@ float MAX31865::singleMeas()
 	}
 	else
 	{
-		while( (configValue & MAX31865_CONFIG_ONE_SHOT) != 0 ) //The one-shot bit should self clear
+		do //The one-shot bit should self clear
 		{
-			stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-		}
+			stat = readRegister<MAX31865_ConfigReg>(&configValue);
+		} while( MAX31865_OneShot::get(configValue) != 0 );
 	}
 
 	if( stat != HAL_OK && errorHandler != NULL)
@@ -221,20 +378,45 @@ float MAX31865::singleMeas()
 	return getTemp();
 }
 
-void MAX31865::startContinousMeas()
+void MAX31865::triggerSingleMeas()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t configValue;
 
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
+	//set the one-shot bit, the conversion starts at the rising edge of CS
+	stat = updateConfig<MAX31865_OneShot::is<1>>();
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += SPI_error;
+		errorHandler(this, errors);
+	}
+}
+
+bool MAX31865::isDataReady()
+{
+	if(DRDYpin != NULL)
+	{
+		return DRDYpin -> digitalRead() == GPIO_PIN_RESET;
+	}
 
-	//new config value
-	configValue |= MAX31865_CONFIG_AUTO_CONV;
+	uint8_t configValue = 0;
+	readRegister<MAX31865_ConfigReg>(&configValue);
 
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
+	return MAX31865_OneShot::get(configValue) == 0; //The one-shot bit should self clear
+}
+
+SPI_HandleTypeDef* MAX31865::getSPIHandle()
+{
+	return hspi;
+}
+
+void MAX31865::startContinousMeas()
+{
+	HAL_StatusTypeDef stat;
+	uint16_t errors = 0;
+
+	stat = updateConfig<MAX31865_ConversionMode::is<1>>();
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -247,16 +429,8 @@ void MAX31865::stopContinousMeas()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t configValue;
-
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-
-	//new config value
-	configValue &= ~MAX31865_CONFIG_AUTO_CONV;
 
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
+	stat = updateConfig<MAX31865_ConversionMode::is<0>>();
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -265,67 +439,89 @@ void MAX31865::stopContinousMeas()
 	}
 }
 
-float MAX31865::getTemp()
+uint16_t MAX31865::getRTD()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t RTDbuff[2] = {0, 0};
-
-	stat = readNFromAddres(MAX31865_RTD_MSB_REG_ADDRESS, RTDbuff, 2);
+	uint16_t RTD = 0;
 
-	uint16_t RTD = (RTDbuff[0] << 8) | RTDbuff[1]; // Combine
+	stat = readRegister<MAX31865_RTDReg>(&RTD);
 
-	if( ( RTD & (uint16_t) 0x1 ) != 0 ) //RTD LSB D0 ( = fault bit)  is set
+	if( MAX31865_RTDFault::get(RTD) != 0 ) //RTD LSB D0 ( = fault bit)  is set
 	{
-		if( errorHandler != NULL )
-		{
-			errors += RTD_fault_general;
-			errorHandler(this, errors);
-		}
+		errors += RTD_fault_general;
 	}
 
-	return tempFromRTD(RTD);
-
-	if( stat != HAL_OK && errorHandler != NULL)
+	if( stat != HAL_OK )
 	{
 		errors += SPI_error;
+	}
+
+	if( errors != 0 && errorHandler != NULL )
+	{
 		errorHandler(this, errors);
 	}
+
+	return RTD;
 }
 
+float MAX31865::getTemp()
+{
+	return tempFromRTD(getRTD());
+}
 
-void MAX31865::runAutofaultDetection()
+void MAX31865::sensorStart()
 {
-	HAL_StatusTypeDef stat;
-	uint16_t errors = 0;
-	uint8_t originalConfigValue;
-	uint8_t faultDetectConfigValue;
-	uint8_t currentConfigValue;
+	//In continuous mode the device is already converting
+	if( MAX31865_ConversionMode::get(configShadow) == 0 )
+	{
+		triggerSingleMeas();
+	}
+}
 
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &originalConfigValue, 1);
+bool MAX31865::sensorReady()
+{
+	return isDataReady();
+}
 
-	//new config value
-	faultDetectConfigValue = originalConfigValue | MAX31865_CONFIG_VBIAS_ON; //V bias ON
+uint32_t MAX31865::sensorReadRaw()
+{
+	return getRTD();
+}
 
-	faultDetectConfigValue &= ~MAX31865_CONFIG_AUTO_CONV; //turn auto OFF
-	faultDetectConfigValue &= ~MAX31865_CONFIG_ONE_SHOT; //turn one-shot OFF
-	faultDetectConfigValue &= ~MAX31865_CONFIG_REG_FAULT_STAT_CLEAR; //fault status clear OFF
+float MAX31865::sensorConvert(uint32_t raw_p)
+{
+	return tempFromRTD((uint16_t)raw_p);
+}
 
-	faultDetectConfigValue |= MAX31865_CONFIG_FAULT_DETECTION_AUTO_DELAY; //start auto fault detect cycle
+uint16_t MAX31865::sensorFaultStatus(uint32_t raw_p)
+{
+	if( MAX31865_RTDFault::get((uint16_t)raw_p) == 0 )
+	{
+		return 0;
+	}
 
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &faultDetectConfigValue, 1);
+	return RTD_fault_general | readFaultStatus();
+}
 
-	//Wait for the cycle to finnish
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &currentConfigValue, 1);
 
+void MAX31865::runAutofaultDetection()
+{
+	HAL_StatusTypeDef stat;
+	uint16_t errors = 0;
+	uint8_t originalConfigValue = configShadow;
+	uint8_t currentConfigValue;
+
+	//V bias ON, auto OFF, start auto fault detect cycle
+	stat = writeConfig( MAX31865_FaultCycle::set(MAX31865_FaultDetectConfig::apply(originalConfigValue), MAX31865_FAULTCYCLE_AUTO) );
+
+	//Wait for the cycle to finnish
 	bool finnished = false;
 
 	for(uint8_t i = 0; i < 100; i++)
 	{
-		stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &currentConfigValue, 1);
-		finnished = ( currentConfigValue & 0b00001100 ) == 0; //Configuration register D3 and D2 are cleared
+		stat = readRegister<MAX31865_ConfigReg>(&currentConfigValue);
+		finnished = MAX31865_FaultCycle::get(currentConfigValue) == MAX31865_FAULTCYCLE_NONE; //Configuration register D3 and D2 are cleared
 
 		if(finnished)
 		{
@@ -350,7 +546,7 @@ void MAX31865::runAutofaultDetection()
 	}
 
 	//Write back the original configuration value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &originalConfigValue, 1);
+	stat = writeConfig(originalConfigValue);
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -363,22 +559,11 @@ void MAX31865::startManualfaultDetectionCycle()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t faultDetectConfigValue;
-
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &manualFaultDetectOriginalConfigReg, 1);
-
-	//new config value
-	faultDetectConfigValue = manualFaultDetectOriginalConfigReg | MAX31865_CONFIG_VBIAS_ON; //V bias ON
 
-	faultDetectConfigValue &= ~MAX31865_CONFIG_AUTO_CONV; //turn auto OFF
-	faultDetectConfigValue &= ~MAX31865_CONFIG_ONE_SHOT; //turn one-shot OFF
-	faultDetectConfigValue &= ~MAX31865_CONFIG_REG_FAULT_STAT_CLEAR; //fault status clear OFF
+	manualFaultDetectOriginalConfigReg = configShadow;
 
-	faultDetectConfigValue |= MAX31865_CONFIG_FAULT_DETECTION_START_MANUAL; //start auto fault detect cycle
-
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &faultDetectConfigValue, 1);
+	//V bias ON, auto OFF, start the first step of the manual cycle
+	stat = writeConfig( MAX31865_FaultCycle::set(MAX31865_FaultDetectConfig::apply(manualFaultDetectOriginalConfigReg), MAX31865_FAULTCYCLE_MANUAL_START) );
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -391,34 +576,18 @@ void MAX31865::endManualfaultDetectionCycle()
 {
 	HAL_StatusTypeDef stat;
 	uint16_t errors = 0;
-	uint8_t originalConfigValue;
-	uint8_t faultDetectConfigValue;
 	uint8_t currentConfigValue;
 
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &originalConfigValue, 1);
-
-	//new config value
-	faultDetectConfigValue = originalConfigValue | MAX31865_CONFIG_VBIAS_ON; //V bias ON
-
-	faultDetectConfigValue &= ~MAX31865_CONFIG_AUTO_CONV; //turn auto OFF
-	faultDetectConfigValue &= ~MAX31865_CONFIG_ONE_SHOT; //turn one-shot OFF
-	faultDetectConfigValue &= ~MAX31865_CONFIG_REG_FAULT_STAT_CLEAR; //fault status clear OFF
-
-	faultDetectConfigValue |= MAX31865_CONFIG_FAULT_DETECTION_STOP_MANUAL; //start auto fault detect cycle
-
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &faultDetectConfigValue, 1);
+	//V bias ON, auto OFF, start the second step of the manual cycle
+	stat = writeConfig( MAX31865_FaultCycle::set(MAX31865_FaultDetectConfig::apply(manualFaultDetectOriginalConfigReg), MAX31865_FAULTCYCLE_MANUAL_STOP) );
 
 	//Wait for the cycle to finnish
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &currentConfigValue, 1);
-
 	bool finnished = false;
 
 	for(uint8_t i = 0; i < 100; i++)
 	{
-		stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &currentConfigValue, 1);
-		finnished = ( currentConfigValue & 0b00001100 ) == 0; //Configuration register D3 and D2 are cleared
+		stat = readRegister<MAX31865_ConfigReg>(&currentConfigValue);
+		finnished = MAX31865_FaultCycle::get(currentConfigValue) == MAX31865_FAULTCYCLE_NONE; //Configuration register D3 and D2 are cleared
 
 		if(finnished)
 		{
@@ -442,7 +611,7 @@ void MAX31865::endManualfaultDetectionCycle()
 	}
 
 	//Write back the original configuration value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &manualFaultDetectOriginalConfigReg, 1);
+	stat = writeConfig(manualFaultDetectOriginalConfigReg);
 
 	if( stat != HAL_OK && errorHandler != NULL)
 	{
@@ -460,8 +629,8 @@ bool MAX31865::faultReadout()
 	uint8_t configValue;
 
 	//test if fault detect cycle is finnished
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-	bool finnished = ( configValue & 0b00001100 ) == 0; //Configuration register D3 and D2 are cleared
+	stat = readRegister<MAX31865_ConfigReg>(&configValue);
+	bool finnished = MAX31865_FaultCycle::get(configValue) == MAX31865_FAULTCYCLE_NONE; //Configuration register D3 and D2 are cleared
 
 	if(! finnished)
 	{
@@ -469,15 +638,10 @@ bool MAX31865::faultReadout()
 	}
 
 	//read fault register
-	stat = readNFromAddres(MAX31865_FAULT_STATUS_REG_ADDRESS, &faultValue, 1);
+	stat = readRegister<MAX31865_FaultStatusReg>(&faultValue);
 
-	//Clear fault register
-	//read current config register
-	stat = readNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
-	//new config value
-	configValue |= MAX31865_CONFIG_REG_FAULT_STAT_CLEAR;
-	//set new config value
-	stat = writeNFromAddres(MAX31865_CONFIG_REG_ADDRESS, &configValue, 1);
+	//Clear fault register, a single write from the shadow register
+	stat = updateConfig<MAX31865_FaultClear::is<1>>();
 
 	if( stat != HAL_OK)
 	{
@@ -492,13 +656,7 @@ bool MAX31865::faultReadout()
 		( (faultValue & FAULT_STATUS_D1) == 0) && ( (faultValue & FAULT_STATUS_D1) == 0) //These bits are "do not care"
 	)
 	{
-
-		if( ( faultValue & FAULT_STATUS_D7 ) != 0 ) { errors += HighThrehsold; }
-		if( ( faultValue & FAULT_STATUS_D6 ) != 0 ) { errors += LowThrehsold; }
-		if( ( faultValue & FAULT_STATUS_D5 ) != 0 ) { errors += VREFINneg_greater_0p85_x_VBIAS; }
-		if( ( faultValue & FAULT_STATUS_D4 ) != 0 ) { errors += VREFINneg_smaller_0p85_x_VBIAS_Force_Open; }
-		if( ( faultValue & FAULT_STATUS_D3 ) != 0 ) { errors += RTDINneg_smaller_0p85_x_VBIAS_Force_Open; }
-		if( ( faultValue & FAULT_STATUS_D2 ) != 0 ) { errors += OV_or_UV; }
+		errors += decodeFaultStatus(faultValue);
 
 		errorHandler(this, errors);
 
@@ -507,4 +665,398 @@ bool MAX31865::faultReadout()
 	return true;
 }
 
+MAX31865_Snapshot_t MAX31865::snapshot()
+{
+	HAL_StatusTypeDef stat;
+	MAX31865_Snapshot_t snap;
+	uint8_t regBuff[MAX31865_REG_COUNT] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+	//One chip-select cycle: address byte + 8 data bytes
+	stat = readNFromAddres(MAX31865_ConfigReg::address, regBuff, MAX31865_REG_COUNT);
+
+	snap.config 		= MAX31865_ConfigReg::fromBytes(regBuff + MAX31865_ConfigReg::address);
+	snap.rtd 			= MAX31865_RTDReg::fromBytes(regBuff + MAX31865_RTDReg::address);
+	snap.highThreshold 	= MAX31865_HighFaultReg::fromBytes(regBuff + MAX31865_HighFaultReg::address);
+	snap.lowThreshold 	= MAX31865_LowFaultReg::fromBytes(regBuff + MAX31865_LowFaultReg::address);
+	snap.faultStatus 	= MAX31865_FaultStatusReg::fromBytes(regBuff + MAX31865_FaultStatusReg::address);
+	snap.temperature 	= tempFromRTD(snap.rtd);
+
+	snap.errors = decodeFaultStatus(snap.faultStatus);
 
+	if( MAX31865_RTDFault::get(snap.rtd) != 0 ) //RTD LSB D0 ( = fault bit)  is set
+	{
+		snap.errors += RTD_fault_general;
+	}
+
+	if( stat != HAL_OK )
+	{
+		snap.errors += SPI_error;
+	}
+
+	if( snap.errors != 0 && errorHandler != NULL )
+	{
+		errorHandler(this, snap.errors);
+	}
+
+	return snap;
+}
+
+HAL_StatusTypeDef MAX31865::writeFaultDetectConfig(uint8_t cycle_p)
+{
+	//V bias ON, auto OFF, the one-shot and fault clear bits are not in the original value
+	return writeConfig( MAX31865_FaultCycle::set(MAX31865_FaultDetectConfig::apply(faultDetectOriginalConfigReg), cycle_p) );
+}
+
+void MAX31865::finishFaultDetection()
+{
+	setFaultDetectState(MAX31865_FAULTDETECT_IDLE);
+
+	if( faultDetectErrors != 0 && errorHandler != NULL )
+	{
+		errorHandler(this, faultDetectErrors);
+	}
+
+	if( faultDetectCallback != NULL )
+	{
+		faultDetectCallback(this, faultDetectErrors);
+	}
+}
+
+void MAX31865::setFaultDetectState(MAX31865_FaultDetectState_t state_p)
+{
+	faultDetectState = state_p;
+	faultDetectStateStart = HAL_GetTick();
+}
+
+bool MAX31865::startFaultDetection( MAX31865_FaultDetectCallback callback_p, bool manual_p )
+{
+	HAL_StatusTypeDef stat;
+
+	if( faultDetectState != MAX31865_FAULTDETECT_IDLE )
+	{
+		return false;
+	}
+
+	faultDetectCallback = callback_p;
+	faultDetectErrors = 0;
+
+	//The shadow holds no self-clearing bits, so written back it does not restart a cycle or clear the faults
+	faultDetectOriginalConfigReg = configShadow;
+
+	if( manual_p )
+	{
+		stat = writeFaultDetectConfig(MAX31865_FAULTCYCLE_MANUAL_START);
+		setFaultDetectState(MAX31865_FAULTDETECT_MANUAL_FIRST);
+	}
+	else
+	{
+		stat = writeFaultDetectConfig(MAX31865_FAULTCYCLE_AUTO);
+		setFaultDetectState(MAX31865_FAULTDETECT_AUTO);
+	}
+
+	if( stat != HAL_OK ) { faultDetectErrors |= SPI_error; }
+
+	return true;
+}
+
+void MAX31865::faultDetectionTick()
+{
+	HAL_StatusTypeDef stat;
+	uint8_t configValue;
+	uint8_t faultValue;
+	uint32_t elapsed = HAL_GetTick() - faultDetectStateStart;
+
+	switch (faultDetectState)
+	{
+		case MAX31865_FAULTDETECT_IDLE:
+			break;
+
+		case MAX31865_FAULTDETECT_MANUAL_FIRST:
+		{
+			//Wait at least 5 time constants before the second step
+			if( elapsed >= TIMECONSTANT_DELAY )
+			{
+				stat = writeFaultDetectConfig(MAX31865_FAULTCYCLE_MANUAL_STOP);
+				if( stat != HAL_OK ) { faultDetectErrors |= SPI_error; }
+				setFaultDetectState(MAX31865_FAULTDETECT_MANUAL_SECOND);
+			}
+			break;
+		}
+
+		case MAX31865_FAULTDETECT_AUTO:
+		case MAX31865_FAULTDETECT_MANUAL_SECOND:
+		{
+			stat = readRegister<MAX31865_ConfigReg>(&configValue);
+			if( stat != HAL_OK ) { faultDetectErrors |= SPI_error; }
+
+			bool finnished = MAX31865_FaultCycle::get(configValue) == MAX31865_FAULTCYCLE_NONE; //Configuration register D3 and D2 are cleared
+
+			if( finnished )
+			{
+				stat = readRegister<MAX31865_FaultStatusReg>(&faultValue);
+				if( stat != HAL_OK ) { faultDetectErrors |= SPI_error; }
+
+				faultDetectErrors |= decodeFaultStatus(faultValue);
+
+				//The fault status is cleared at the end, a crossing of the threshold window is kept for thresholdTripped()
+				if( ( faultDetectErrors & (HighThrehsold | LowThrehsold) ) != 0 ) { thresholdTripCarried = true; }
+
+				//let the circuit leave the transient
+				setFaultDetectState(MAX31865_FAULTDETECT_SETTLING);
+			}
+			else if( elapsed > FAULT_DETECT_TIMEOUT )
+			{
+				faultDetectErrors |= Fault_detect_stuck;
+				setFaultDetectState(MAX31865_FAULTDETECT_SETTLING);
+			}
+			break;
+		}
+
+		case MAX31865_FAULTDETECT_SETTLING:
+		{
+			if( elapsed >= TIMECONSTANT_DELAY )
+			{
+				//Write back the original configuration value and clear the fault register
+				stat = writeConfig( FieldUpdate<MAX31865_FaultClear::is<1>>::apply(faultDetectOriginalConfigReg) );
+				if( stat != HAL_OK ) { faultDetectErrors |= SPI_error; }
+
+				//If it was converting continuously, the first new conversion is waited for
+				if( MAX31865_ConversionMode::get(faultDetectOriginalConfigReg) != 0 )
+				{
+					setFaultDetectState(MAX31865_FAULTDETECT_RESTARTING);
+					break;
+				}
+
+				finishFaultDetection();
+			}
+			break;
+		}
+
+		case MAX31865_FAULTDETECT_RESTARTING:
+		{
+			if( elapsed >= getConversionTime() )
+			{
+				finishFaultDetection();
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+bool MAX31865::isFaultDetectionBusy()
+{
+	return faultDetectState != MAX31865_FAULTDETECT_IDLE;
+}
+
+uint32_t MAX31865::getConversionTime()
+{
+	if( filterSetting == MAX31865_FILTER_60HZ )
+	{
+		return CONVERSION_TIME_60HZ;
+	}
+	return CONVERSION_TIME_50HZ;
+}
+
+uint32_t MAX31865::getContinuousPeriod()
+{
+	if( filterSetting == MAX31865_FILTER_60HZ )
+	{
+		return CONTINUOUS_PERIOD_60HZ;
+	}
+	return CONTINUOUS_PERIOD_50HZ;
+}
+
+uint32_t MAX31865::getFaultDetectCost()
+{
+	return FAULT_DETECT_AUTO_CYCLE_TIME + TIMECONSTANT_DELAY + getConversionTime();
+}
+
+bool MAX31865::planFaultDetection( uint32_t samplePeriod_p, uint32_t detectInterval_p, MAX31865_FaultDetectCallback callback_p )
+{
+	faultDetectCost = getFaultDetectCost();
+
+	//The detection has to finish before the next sample is due
+	if( samplePeriod_p == 0 || faultDetectCost + FAULT_DETECT_GUARD_TIME > samplePeriod_p )
+	{
+		faultDetectEverySamples = 0;
+		return false;
+	}
+
+	plannedSamplePeriod = samplePeriod_p;
+	plannedFaultDetectCallback = callback_p;
+
+	faultDetectEverySamples = detectInterval_p / samplePeriod_p;
+	if( faultDetectEverySamples == 0 ) { faultDetectEverySamples = 1; }
+
+	samplesSinceFaultDetect = 0;
+
+	return true;
+}
+
+bool MAX31865::sampleTaken()
+{
+	if( faultDetectEverySamples == 0 )
+	{
+		return false;
+	}
+
+	samplesSinceFaultDetect++;
+
+	if( samplesSinceFaultDetect < faultDetectEverySamples )
+	{
+		return false;
+	}
+
+	if( !startFaultDetection(plannedFaultDetectCallback) )
+	{
+		return false; //Still busy, retried after the next sample
+	}
+
+	samplesSinceFaultDetect = 0;
+	return true;
+}
+
+uint32_t MAX31865::getFaultDetectCostPerHour()
+{
+	if( faultDetectEverySamples == 0 )
+	{
+		return 0;
+	}
+
+	uint32_t detectPeriod = plannedSamplePeriod * faultDetectEverySamples;
+	return (uint32_t)(((uint64_t)3600000 * faultDetectCost) / detectPeriod);
+}
+
+void MAX31865::setBiasSettling( uint8_t timeConstants_p, uint32_t timeConstant_p )
+{
+	//Rounded up to whole ms, plus 1 ms as asked by the datasheet
+	biasSettleTime = ( (uint32_t)timeConstants_p * timeConstant_p + 999 ) / 1000 + 1;
+}
+
+uint32_t MAX31865::getBiasSettleTime()
+{
+	return biasSettleTime;
+}
+
+void MAX31865::setBias( bool on_p )
+{
+	HAL_StatusTypeDef stat;
+	uint16_t errors = 0;
+
+	if( on_p ) { stat = updateConfig<MAX31865_VBias::is<1>>(); }
+	else { stat = updateConfig<MAX31865_VBias::is<0>, MAX31865_ConversionMode::is<0>>(); }
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += SPI_error;
+		errorHandler(this, errors);
+	}
+}
+
+void MAX31865::setDutyCycleState(MAX31865_DutyCycleState_t state_p)
+{
+	dutyCycleState = state_p;
+	dutyCycleStateStart = HAL_GetTick();
+}
+
+void MAX31865::finishDutyCycledMeas(MAX31865_DutyCycleState_t state_p)
+{
+	if( updateConfig<MAX31865_VBias::is<0>>() != HAL_OK )
+	{
+		dutyCycleResult.errors |= SPI_error;
+	}
+
+	setDutyCycleState(state_p);
+}
+
+bool MAX31865::startDutyCycledMeas()
+{
+	HAL_StatusTypeDef stat;
+
+	if( dutyCycleState == MAX31865_DUTYCYCLE_SETTLING || dutyCycleState == MAX31865_DUTYCYCLE_CONVERTING || isFaultDetectionBusy() )
+	{
+		return false;
+	}
+
+	//An old conversion that was not read out would hold DRDY low
+	if( DRDYpin != NULL && DRDYpin -> digitalRead() == GPIO_PIN_RESET )
+	{
+		getRTD();
+	}
+
+	//VBIAS on, no conversion yet
+	stat = updateConfig<MAX31865_VBias::is<1>, MAX31865_ConversionMode::is<0>>();
+
+	if( stat != HAL_OK )
+	{
+		if( errorHandler != NULL ) { errorHandler(this, SPI_error); }
+		return false;
+	}
+
+	setDutyCycleState(MAX31865_DUTYCYCLE_SETTLING);
+
+	return true;
+}
+
+void MAX31865::dutyCycleTick()
+{
+	uint32_t elapsed = HAL_GetTick() - dutyCycleStateStart;
+
+	switch (dutyCycleState)
+	{
+		case MAX31865_DUTYCYCLE_SETTLING:
+		{
+			if( elapsed >= biasSettleTime )
+			{
+				//The conversion starts at the rising edge of CS, VBIAS stays on
+				if( updateConfig<MAX31865_OneShot::is<1>>() != HAL_OK )
+				{
+					dutyCycleResult.errors = SPI_error;
+					finishDutyCycledMeas(MAX31865_DUTYCYCLE_IDLE);
+					if( errorHandler != NULL ) { errorHandler(this, SPI_error); }
+					break;
+				}
+
+				setDutyCycleState(MAX31865_DUTYCYCLE_CONVERTING);
+			}
+			break;
+		}
+
+		case MAX31865_DUTYCYCLE_CONVERTING:
+		{
+			if( isDataReady() )
+			{
+				dutyCycleResult = snapshot();
+				finishDutyCycledMeas(MAX31865_DUTYCYCLE_DONE);
+			}
+			else if( elapsed > 2 * getConversionTime() )
+			{
+				//No result, VBIAS must not stay on
+				finishDutyCycledMeas(MAX31865_DUTYCYCLE_IDLE);
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+bool MAX31865::isDutyCycledMeasBusy()
+{
+	return dutyCycleState == MAX31865_DUTYCYCLE_SETTLING || dutyCycleState == MAX31865_DUTYCYCLE_CONVERTING;
+}
+
+bool MAX31865::isDutyCycledMeasDone()
+{
+	return dutyCycleState == MAX31865_DUTYCYCLE_DONE;
+}
+
+MAX31865_Snapshot_t MAX31865::getDutyCycledResult()
+{
+	setDutyCycleState(MAX31865_DUTYCYCLE_IDLE);
+	return dutyCycleResult;
+}
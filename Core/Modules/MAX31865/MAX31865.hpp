@@ -14,14 +14,52 @@
 
 #include "GPIO.hpp"
 #include "MAX31865_Regmap.hpp"
+#include "Sensor.hpp"
 #include "stm32f4xx_hal.h"
 #include <stdint.h>
 
+/// Default value of the reference resistor [ohm], can be changed with \link MAX31865::setReferenceResistor \endlink
 #define R_REF 423
 
+/// Temperature coefficient of the RTD [ohm/C], per 100 ohm of R0
+#define RTD_ALPHA_PT100 0.385
+
+/// Gain of the calibration equal to 1, the gain is stored in Q16 fixed-point
+#define MAX31865_CAL_UNITY_GAIN 65536
+
+/// Smallest distance of the two calibration points [C]
+#define MAX31865_CAL_MIN_SPAN 1.0
+
 /// Delay after fault check to let the circuit stabilize
 #define TIMECONSTANT_DELAY 100
 
+/// Maximum time a fault detection cycle may take before it is considered stuck [ms]
+#define FAULT_DETECT_TIMEOUT 100
+
+/// Duration of the automatic fault detection cycle, rounded up [ms] (about 550us according to the datasheet)
+#define FAULT_DETECT_AUTO_CYCLE_TIME 1
+
+/// Single (or first continuous) conversion time with the 60Hz filter, maximum [ms]
+#define CONVERSION_TIME_60HZ 55
+
+/// Single (or first continuous) conversion time with the 50Hz filter, maximum [ms]
+#define CONVERSION_TIME_50HZ 67
+
+/// Continuous conversion period with the 60Hz filter [us]
+#define CONTINUOUS_PERIOD_60HZ 16667
+
+/// Continuous conversion period with the 50Hz filter [us]
+#define CONTINUOUS_PERIOD_50HZ 20000
+
+/// Default time constant of the RTD input filter, depends on the board [us]
+#define BIAS_TIME_CONSTANT 1000
+
+/// Default number of input filter time constants waited after VBIAS is turned on (the datasheet asks for 10.5)
+#define BIAS_SETTLE_TIME_CONSTANTS 11
+
+/// Margin kept free before the next sample when planning a fault detection [ms]
+#define FAULT_DETECT_GUARD_TIME 50
+
 /// @brief Checks if the measured resistance is greater than the high fault threshold.
 /// @param err Error code to be checked.
 /// @return True if the high threshold error is present, false otherwise.
@@ -105,10 +143,60 @@ typedef enum{
 	PT1000	/*!< Use this if the connected RTD is a PT1000 */
 } RTD_type_t;
 
+/**
+ * @struct MAX31865_Snapshot_t
+ * @brief Decoded content of every register of the device, read in a single SPI transaction.
+ */
+typedef struct{
+	uint8_t config;				/*!< Value of the configuration register */
+	uint16_t rtd;				/*!< Raw value of the RTD registers (D0 is the fault bit) */
+	uint16_t highThreshold;		/*!< Raw value of the High Fault Threshold registers */
+	uint16_t lowThreshold;		/*!< Raw value of the Low Fault Threshold registers */
+	uint8_t faultStatus;		/*!< Raw value of the fault status register */
+	float temperature;			/*!< The RTD value converted into celsius */
+	uint16_t errors;			/*!< Decoded \link MAX31865_ErrorCode_t error flags\endlink, 0 if everything is fine */
+} MAX31865_Snapshot_t;
+
+/**
+ * @struct MAX31865_Calibration_t
+ * @brief Two-point calibration of a probe: T = gain * T<SUB>nominal</SUB> + offset
+ */
+typedef struct{
+	int32_t gain;		/*!< Gain in Q16 fixed-point, \link MAX31865_CAL_UNITY_GAIN \endlink is 1 */
+	int32_t offset;		/*!< Offset [mC] */
+} MAX31865_Calibration_t;
+
+/**
+ * @enum MAX31865_FaultDetectState_t
+ * @brief States of the non-blocking fault detection.
+ */
+typedef enum{
+	MAX31865_FAULTDETECT_IDLE,			/*!< No fault detection is running */
+	MAX31865_FAULTDETECT_AUTO,			/*!< Automatic cycle started, waiting for D3:D2 to clear */
+	MAX31865_FAULTDETECT_MANUAL_FIRST,	/*!< First step of the manual cycle, waiting for the input filter to settle */
+	MAX31865_FAULTDETECT_MANUAL_SECOND,	/*!< Second step of the manual cycle, waiting for D3:D2 to clear */
+	MAX31865_FAULTDETECT_SETTLING,		/*!< Cycle finished, letting the circuit leave the transient */
+	MAX31865_FAULTDETECT_RESTARTING,	/*!< Original configuration restored, waiting for the first new conversion */
+} MAX31865_FaultDetectState_t;
+
+/**
+ * @enum MAX31865_DutyCycleState_t
+ * @brief States of the duty-cycled single-shot measurement.
+ */
+typedef enum{
+	MAX31865_DUTYCYCLE_IDLE,			/*!< VBIAS is off, no measurement is running */
+	MAX31865_DUTYCYCLE_SETTLING,		/*!< VBIAS turned on, waiting for the input filter to settle */
+	MAX31865_DUTYCYCLE_CONVERTING,		/*!< Single-shot conversion running */
+	MAX31865_DUTYCYCLE_DONE,			/*!< VBIAS turned off again, the result waits to be read */
+} MAX31865_DutyCycleState_t;
+
 class MAX31865; // Forward declaration
 
 typedef void(*MAX31865_ErroHandler)( MAX31865* caller, uint16_t ErrorCode_p );
 
+/// @brief Called when a non-blocking fault detection has finished. ErrorCode_p holds the \link MAX31865_ErrorCode_t error flags\endlink, 0 if no fault was found.
+typedef void(*MAX31865_FaultDetectCallback)( MAX31865* caller, uint16_t ErrorCode_p );
+
 
 
 /**
@@ -116,6 +204,7 @@ typedef void(*MAX31865_ErroHandler)( MAX31865* caller, uint16_t ErrorCode_p );
  *
  * With this driver the basic functionality of the IC can be accessed. Temperature reading can be done as well as setting the upper and lower thresholds.
  * This class supports both  continuous and single-shot measurement modes. The built-in error detection of the amplifier is also supported.
+ * It implements the \link Sensor \endlink interface, the raw value is the content of the RTD registers and it is converted to celsius.
  *
  *
  * Example:
@@ -138,12 +227,39 @@ typedef void(*MAX31865_ErroHandler)( MAX31865* caller, uint16_t ErrorCode_p );
 	float singleMeas = myPT100.singleMeas();
  * \endcode
  * */
-class MAX31865{
+class MAX31865 : public Sensor<MAX31865>{
+	friend class Sensor<MAX31865>;
 private:
 	/**
 	 * @brief The type of the RTD connected to the sensor determines the resistance at 0C. The type of RTD can be set with the \link MAX31865 constructor \endlink
 	 */
-	uint8_t r0;
+	uint16_t r0;
+
+	/**
+	 * @brief Value of the reference resistor [ohm]
+	 */
+	float rRef = R_REF;
+
+	/**
+	 * @brief The calibration of the probe, see \link MAX31865::setCalibration setCalibration \endlink
+	 */
+	MAX31865_Calibration_t calibration = { MAX31865_CAL_UNITY_GAIN, 0 };
+
+	/**
+	 * @brief Temperature of one RTD code with the calibration applied [mC/code], Q16 fixed-point
+	 */
+	int32_t convSlope;
+
+	/**
+	 * @brief Temperature of RTD code 0 with the calibration applied [mC]
+	 */
+	int32_t convIntercept;
+
+	/**
+	 * @brief Recompute \link MAX31865::convSlope convSlope \endlink and \link MAX31865::convIntercept convIntercept \endlink,
+	 * the floating point work of the conversion is done here once, not for every sample
+	 */
+	void updateConversion();
 
 	/**
 	 * @brief The HAL SPI handle that will be used to communicate with the device
@@ -188,31 +304,219 @@ private:
 	*
 	* @param addr_p memory address where the data starts
 	* @param rBuff_p pointer where to the new data is stored
-	* @param dataSize_p the size of the data to be written
+	* @param dataSize_p the size of the data to be written, at most 4 bytes
 	*
-	* @returns an HAL_StatusTypeDef that represents the succes of the communication
+	* @returns an HAL_StatusTypeDef that represents the succes of the communication, HAL_ERROR if the data is too long
 	*/
 	HAL_StatusTypeDef writeNFromAddres( uint8_t addr_p, uint8_t* wBuff_p, uint32_t dataSize_p );
 
     /**
-	* @brief Convert raw RTD reading into Celsius
+	* @brief Reads a register described in \link MAX31865_Regmap.hpp \endlink
 	*
-	* @param rtdValue_p raw RTD reading
+	* @param value_p where the register value is stored
 	*/
-	float tempFromRTD(uint16_t rtdValue_p);
+	template<typename Reg_p>
+	HAL_StatusTypeDef readRegister( typename Reg_p::value_t* value_p )
+	{
+		uint8_t buff[Reg_p::width];
+		HAL_StatusTypeDef stat = readNFromAddres(Reg_p::address, buff, Reg_p::width);
+		*value_p = Reg_p::fromBytes(buff);
+		return stat;
+	}
 
     /**
-	* @brief Converts temperature given in Celsius into corresponding RTD reading
+	* @brief Writes a register described in \link MAX31865_Regmap.hpp \endlink
 	*
-	* @param tempValue_p temprature in Celsius to be converted
+	* @param value_p the new register value
 	*/
-	uint16_t RTDFromTemp(float tempValue_p);
+	template<typename Reg_p>
+	HAL_StatusTypeDef writeRegister( typename Reg_p::value_t value_p )
+	{
+		static_assert( Reg_p::writable, "The register is read-only" );
+
+		uint8_t buff[Reg_p::width];
+		Reg_p::toBytes(value_p, buff);
+		return writeNFromAddres(Reg_p::address, buff, Reg_p::width);
+	}
+
+    /**
+	* @brief Writes the High and Low Fault Threshold registers with a single transaction and clears the fault status
+	*
+	* @param high_p raw value of the High Fault Threshold registers
+	* @param low_p raw value of the Low Fault Threshold registers
+	*/
+	void writeThresholds( uint16_t high_p, uint16_t low_p );
+
+    /**
+	* @brief The last value written into the configuration register, without the self-clearing bits
+	*
+	* The configuration is only changed by this driver, so every update is computed from this copy and written
+	* with a single transaction, no read is needed before it.
+	*/
+	uint8_t configShadow = 0;
+
+    /**
+	* @brief Writes the configuration register and updates \link MAX31865::configShadow configShadow \endlink
+	*
+	* @param configValue_p the new value of the configuration register
+	*/
+	HAL_StatusTypeDef writeConfig( uint8_t configValue_p );
+
+    /**
+	* @brief Changes the given fields of the configuration register with a single write
+	*
+	* Example:
+		* \code
+		updateConfig< MAX31865_VBias::is<0>, MAX31865_ConversionMode::is<0> >();
+		* \endcode
+	*/
+	template<typename... Values_p>
+	HAL_StatusTypeDef updateConfig()
+	{
+		return writeConfig( FieldUpdate<Values_p...>::apply(configShadow) );
+	}
+
+    /**
+	* @brief Converts the value of the fault status register into \link MAX31865_ErrorCode_t error flags\endlink
+	*
+	* @param faultValue_p value of the fault status register
+	*/
+	uint16_t decodeFaultStatus(uint8_t faultValue_p);
 
     /**
 	* @brief Used to store the value of the config reg between the start and the end of a manual fault detection cycle
 	*/
 	uint8_t manualFaultDetectOriginalConfigReg;
 
+	/**
+	* @brief Current state of the non-blocking fault detection
+	*/
+	volatile MAX31865_FaultDetectState_t faultDetectState = MAX31865_FAULTDETECT_IDLE;
+
+	/**
+	* @brief The configuration register before the non-blocking fault detection was started
+	*/
+	uint8_t faultDetectOriginalConfigReg;
+
+	/**
+	* @brief HAL tick when the current state of the non-blocking fault detection was entered
+	*/
+	uint32_t faultDetectStateStart;
+
+	/**
+	* @brief Error flags collected during the non-blocking fault detection
+	*/
+	uint16_t faultDetectErrors;
+
+	/**
+	* @brief A threshold fault found by the fault detection, the fault status is cleared at its end
+	*
+	* Reported by the next \link MAX31865::thresholdTripped thresholdTripped \endlink, so a crossing of the window is not lost.
+	*/
+	bool thresholdTripCarried = false;
+
+	/**
+	* @brief Called when the non-blocking fault detection finishes
+	*/
+	MAX31865_FaultDetectCallback faultDetectCallback = NULL;
+
+	/**
+	* @brief Number of logged samples between two planned fault detections, 0 if no detection is planned
+	*/
+	uint32_t faultDetectEverySamples = 0;
+
+	/**
+	* @brief Logged samples since the last planned fault detection
+	*/
+	uint32_t samplesSinceFaultDetect = 0;
+
+	/**
+	* @brief Time cost of one planned fault detection [ms]
+	*/
+	uint32_t faultDetectCost = 0;
+
+	/**
+	* @brief Period of the logged samples given in \link MAX31865::planFaultDetection planFaultDetection \endlink [ms]
+	*/
+	uint32_t plannedSamplePeriod = 0;
+
+	/**
+	* @brief Callback used by the planned fault detections
+	*/
+	MAX31865_FaultDetectCallback plannedFaultDetectCallback = NULL;
+
+	/**
+	* @brief Current state of the duty-cycled measurement
+	*/
+	volatile MAX31865_DutyCycleState_t dutyCycleState = MAX31865_DUTYCYCLE_IDLE;
+
+	/**
+	* @brief HAL tick when the current state of the duty-cycled measurement was entered
+	*/
+	uint32_t dutyCycleStateStart;
+
+	/**
+	* @brief Time VBIAS is kept on before the conversion [ms]
+	*/
+	uint32_t biasSettleTime;
+
+	/**
+	* @brief The result of the last duty-cycled measurement
+	*/
+	MAX31865_Snapshot_t dutyCycleResult;
+
+	/**
+	* @brief Switch the duty-cycled measurement into a new state
+	*/
+	void setDutyCycleState(MAX31865_DutyCycleState_t state_p);
+
+	/**
+	* @brief Turn VBIAS off and end the duty-cycled measurement
+	*/
+	void finishDutyCycledMeas(MAX31865_DutyCycleState_t state_p);
+
+	/**
+	* @brief Switch the non-blocking fault detection into a new state
+	*/
+	void setFaultDetectState(MAX31865_FaultDetectState_t state_p);
+
+	/**
+	* @brief End the non-blocking fault detection and report the result to the error handler and the callback
+	*/
+	void finishFaultDetection();
+
+	/**
+	* @brief Write the fault detection cycle (D3:D2) into the configuration register, with conversions stopped and VBIAS on
+	*
+	* @param cycle_p one of the MAX31865_FAULTCYCLE_... values
+	*/
+	HAL_StatusTypeDef writeFaultDetectConfig(uint8_t cycle_p);
+
+	/**
+	* @brief \link Sensor::start \endlink, triggers a single-shot conversion unless the device is in continuous mode
+	*/
+	void sensorStart();
+
+	/**
+	* @brief \link Sensor::ready \endlink, see \link MAX31865::isDataReady isDataReady \endlink
+	*/
+	bool sensorReady();
+
+	/**
+	* @brief \link Sensor::readRaw \endlink, the RTD registers with the fault bit
+	*/
+	uint32_t sensorReadRaw();
+
+	/**
+	* @brief \link Sensor::convert \endlink, the temperature in celsius
+	*/
+	float sensorConvert(uint32_t raw_p);
+
+	/**
+	* @brief \link Sensor::faultStatus \endlink, the fault status register is only read if the fault bit of the sample is set
+	*/
+	uint16_t sensorFaultStatus(uint32_t raw_p);
+
 public:
 
     /**
@@ -222,10 +526,11 @@ public:
 	* @param csPin_p the chip select pin
 	* @param DRDYpin_p the DRDY pin
 	* @param RTD_type_p the type of RTD used (PT100 or PT1000) defaults to PT100
+	* @param rRef_p the value of the reference resistor in ohm
 	*
 	* @note before use the \link MAX31865::init \endlink function also have to be called
 	*/
-	MAX31865( SPI_HandleTypeDef *hspi_p, GPIO* csPin_p , GPIO* DRDYpin_p = NULL, RTD_type_t RTD_type_p = PT100 );
+	MAX31865( SPI_HandleTypeDef *hspi_p, GPIO* csPin_p , GPIO* DRDYpin_p = NULL, RTD_type_t RTD_type_p = PT100, float rRef_p = R_REF );
 
     /**
 	* @brief Initialize the device
@@ -345,6 +650,49 @@ public:
 	*/
 	void setLowerThreshold(float thr_p);
 
+	/**
+	* @brief Sets both thresholds as a window around a given temperature
+	*
+	* The four threshold registers are written with a single SPI transaction. The fault status is cleared as well,
+	* so the next \link HighThrehsold \endlink or \link LowThrehsold \endlink flag means that the temperature has left the new window.
+	*
+	* @param center_p The middle of the window in celsius
+	* @param deadband_p Half width of the window in celsius
+	*/
+	void setThresholdWindow(float center_p, float deadband_p);
+
+	/**
+	* @brief Opens the threshold window to the whole range
+	*
+	* The registers get their power-on values (0xFFFF and 0x0000) and the fault status is cleared,
+	* so no conversion trips a threshold fault any more.
+	*/
+	void clearThresholdWindow();
+
+	/**
+	* @brief Check if the temperature has left the threshold window
+	*
+	* Only the fault status register is read, so this is a short SPI transaction. The fault status is not cleared.
+	* A crossing found by the last fault detection is reported as well, as that has cleared the fault status.
+	*
+	* @returns True if the High or Low Fault Threshold was crossed
+	*/
+	bool thresholdTripped();
+
+	/**
+	* @brief Reads the fault status register without clearing it
+	*
+	* Only the fault status register is read, so this is a short SPI transaction.
+	*
+	* @returns The \link MAX31865_ErrorCode_t error flags\endlink set in the fault status register
+	*/
+	uint16_t readFaultStatus();
+
+	/**
+	* @brief Clears the fault status register
+	*/
+	void clearFaults();
+
 	/**
 	* @brief Gets the set upper threshold value
 	*
@@ -375,6 +723,119 @@ public:
 	*/
 	float singleMeas();
 
+    /**
+	* @brief Convert raw RTD reading into Celsius, with the calibration applied
+	*
+	* @param rtdValue_p raw RTD reading, as read from the RTD registers (D0 is the fault bit)
+	*
+	* @see MAX31865::milliCelsiusFromRTD
+	*/
+	float tempFromRTD(uint16_t rtdValue_p);
+
+    /**
+	* @brief Convert raw RTD reading into milli celsius, with the calibration applied
+	*
+	* Only integer operations are used (one multiplication and one addition), the reference resistor, R0 and the calibration
+	* are folded into two precomputed coefficients.
+	*
+	* @param rtdValue_p raw RTD reading, as read from the RTD registers (D0 is the fault bit)
+	*/
+	int32_t milliCelsiusFromRTD(uint16_t rtdValue_p);
+
+    /**
+	* @brief Converts temperature given in Celsius into corresponding RTD reading
+	*
+	* @param tempValue_p temprature in Celsius to be converted
+	*
+	* @returns The RTD value in the format of the RTD registers (D0 is the fault bit)
+	*/
+	uint16_t RTDFromTemp(float tempValue_p);
+
+    /**
+	* @brief Set the value of the reference resistor
+	*
+	* @param rRef_p the resistance in ohm
+	*
+	* @note The calibration is relative to this value, so it has to be set before the probe is calibrated
+	*/
+	void setReferenceResistor(float rRef_p);
+
+    /**
+	* @brief Get the value of the reference resistor in ohm
+	*/
+	float getReferenceResistor();
+
+    /**
+	* @brief Set the calibration of the probe, it is applied to every conversion from now on
+	*
+	* @param calibration_p the gain and offset, a gain of 0 or less restores the uncalibrated conversion
+	*/
+	void setCalibration(MAX31865_Calibration_t calibration_p);
+
+    /**
+	* @brief Get the calibration of the probe
+	*/
+	MAX31865_Calibration_t getCalibration();
+
+    /**
+	* @brief Compute and set the calibration from two reference points
+	*
+	* Example:
+		* \code
+		//probe in ice water
+		uint16_t rtdIce = myPT100.getRTD();
+		⋮
+		//probe in boiling water
+		uint16_t rtdBoil = myPT100.getRTD();
+
+		myPT100.calibrateTwoPoint(rtdIce, 0, rtdBoil, 100);
+	 * \endcode
+	*
+	* @param rtd1_p raw RTD reading at the first point
+	* @param reference1_p the true temperature of the first point in celsius
+	* @param rtd2_p raw RTD reading at the second point
+	* @param reference2_p the true temperature of the second point in celsius
+	*
+	* @returns False if the points are closer than \link MAX31865_CAL_MIN_SPAN \endlink or the gain would be unrealistic, the calibration is not changed then
+	*/
+	bool calibrateTwoPoint(uint16_t rtd1_p, float reference1_p, uint16_t rtd2_p, float reference2_p);
+
+	/**
+	* @brief Get the raw value of the device's RTD registers
+	*
+	* Same as \link MAX31865::getTemp getTemp \endlink, without the conversion. Useful if the samples are filtered before converting.
+	*
+	* @returns The raw RTD value (D0 is the fault bit)
+	*/
+	uint16_t getRTD();
+
+	/**
+	* @brief Start a single-shot measurement without waiting for the result
+	*
+	* The conversion takes about 52ms (60Hz filter) or 62.5ms (50Hz filter). Use \link MAX31865::isDataReady isDataReady \endlink to check if it has finished,
+	* then read the result with \link MAX31865::getTemp getTemp \endlink or \link MAX31865::snapshot snapshot \endlink.
+	* This way the conversions of several devices can overlap.
+	*/
+	void triggerSingleMeas();
+
+	/**
+	* @brief Check if a new conversion result is available
+	*
+	* If the DRDY pin is attached, its state is used (active low). Otherwise the self-clearing one-shot bit of the configuration register is checked.
+	*
+	* @returns True if the result of the last conversion can be read
+	*
+	* @note Without a DRDY pin, in continuous mode this always returns true.
+	*/
+	bool isDataReady();
+
+	/**
+	* @brief Get the HAL SPI handle used by the device
+	*
+	* @returns The SPI handle given in the \link MAX31865 constructor \endlink
+	*/
+	SPI_HandleTypeDef* getSPIHandle();
+
 	/**
 	* @brief Start continuous measurement
 	*
@@ -462,6 +923,194 @@ public:
 	* \endcode
 	*/
 	bool faultReadout();
+
+	/**
+	* @brief Read every register of the device in one burst
+	*
+	* As the device auto-increments the register address, the configuration, RTD, threshold and fault status registers
+	* can be read with a single chip-select cycle. The result is decoded, so one call gives both the measured value and its health status.
+	* If an error is found, the attached error handler is called as well.
+	*
+	* @returns The decoded \link MAX31865_Snapshot_t snapshot\endlink of the registers
+	*
+	* @note The fault status register is not cleared, use \link MAX31865::faultReadout faultReadout \endlink for that.
+	*
+	* Example:
+	* \code
+	  MAX31865_Snapshot_t snap = myPT100.snapshot();
+	  if(snap.errors == 0)
+	  {
+		  mySerial.println(snap.temperature);
+	  }
+	* \endcode
+	*/
+	MAX31865_Snapshot_t snapshot();
+
+	/**
+	* @brief Start a fault detection without blocking
+	*
+	* The cycle is carried out by \link MAX31865::faultDetectionTick faultDetectionTick \endlink, which has to be called regularly (e.g. from the main loop or a timer callback).
+	* When the cycle has finished, the fault register is read and cleared, the original configuration is restored and the callback is called with the decoded error flags.
+	*
+	* @param callback_p function to be called when the detection has finished (can be NULL)
+	* @param manual_p if true the two step manual cycle is used, needed if the input filter has a time constant greater than 100us
+	*
+	* @returns False if a detection is already running
+	*
+	* Example:
+	* \code
+	  void faultDetectDone( MAX31865* caller, uint16_t ErrorCode_p )
+	  {
+		  if( ErrorCode_p != 0 ) { mySerial.println("X"); }
+	  }
+	  ⋮
+	  myPT100.startFaultDetection(faultDetectDone);
+	  while (1)
+	  {
+		  myPT100.faultDetectionTick();
+		  ⋮
+	  }
+	* \endcode
+	*/
+	bool startFaultDetection( MAX31865_FaultDetectCallback callback_p, bool manual_p = false );
+
+	/**
+	* @brief Advance the non-blocking fault detection
+	*
+	* Never waits, every call does at most a few SPI transactions. Does nothing if no detection is running.
+	*/
+	void faultDetectionTick();
+
+	/**
+	* @brief Check if a non-blocking fault detection is running
+	*
+	* @returns True while the detection is running, in this time the device is not converting
+	*/
+	bool isFaultDetectionBusy();
+
+	/**
+	* @brief Get the time of a single conversion with the current filter setting
+	*
+	* @returns The maximal conversion time in ms
+	*/
+	uint32_t getConversionTime();
+
+	/**
+	* @brief Get the time between two conversions in continuous mode
+	*
+	* @returns The conversion period in us
+	*/
+	uint32_t getContinuousPeriod();
+
+	/**
+	* @brief Get the time the device is not measuring because of one automatic fault detection
+	*
+	* This includes the cycle itself, the settling of the circuit and the first conversion after the original mode was restored.
+	*
+	* @returns The cost of one fault detection in ms
+	*/
+	uint32_t getFaultDetectCost();
+
+	/**
+	* @brief Plan automatic fault detections into the idle time between logged samples
+	*
+	* After this, every call of \link MAX31865::sampleTaken sampleTaken \endlink counts a logged sample, and when a detection is due,
+	* it is started right after the sample. As it finishes (continuous mode restored and the first conversion done) well before the next sample, no sample is lost.
+	*
+	* @param samplePeriod_p the period of the logged samples [ms]
+	* @param detectInterval_p how often a detection should be run [ms], it is rounded to a whole number of sample periods
+	* @param callback_p called when a detection has finished (can be NULL)
+	*
+	* @returns False if a detection does not fit between two samples, in this case no detection is planned
+	*/
+	bool planFaultDetection( uint32_t samplePeriod_p, uint32_t detectInterval_p, MAX31865_FaultDetectCallback callback_p );
+
+	/**
+	* @brief Tell the scheduler that a sample has been logged
+	*
+	* Starts the planned fault detection if it is due. Call it right after the device was read out.
+	*
+	* @returns True if a fault detection was started
+	*/
+	bool sampleTaken();
+
+	/**
+	* @brief Get how long the planned fault detections keep the device from measuring
+	*
+	* @returns The cost of the planned detections in ms per hour, 0 if no detection is planned
+	*/
+	uint32_t getFaultDetectCostPerHour();
+
+	/**
+	* @brief Set how long VBIAS is kept on before a duty-cycled conversion
+	*
+	* The settling time is the given number of input filter time constants plus 1 ms.
+	*
+	* @param timeConstants_p number of time constants to wait
+	* @param timeConstant_p time constant of the input filter [us]
+	*/
+	void setBiasSettling( uint8_t timeConstants_p = BIAS_SETTLE_TIME_CONSTANTS, uint32_t timeConstant_p = BIAS_TIME_CONSTANT );
+
+	/**
+	* @brief Get how long VBIAS is kept on before a duty-cycled conversion
+	*
+	* @returns The settling time in ms
+	*/
+	uint32_t getBiasSettleTime();
+
+	/**
+	* @brief Turn VBIAS on or off
+	*
+	* With VBIAS off the RTD is not heated and the device draws less current between the measurements.
+	* Turning it off also stops continuous mode, as it needs VBIAS.
+	*
+	* @param on_p true to turn VBIAS on
+	*/
+	void setBias( bool on_p );
+
+	/**
+	* @brief Start a non-blocking single-shot measurement with VBIAS only turned on for the time needed
+	*
+	* VBIAS is turned on, after the settling time the conversion is started, and when it is done VBIAS is turned off again.
+	* The steps are made by \link MAX31865::dutyCycleTick dutyCycleTick \endlink, no delay is used.
+	*
+	* Example:
+	* \code
+	  myPT100.setBias(false);
+	  ⋮
+	  myPT100.startDutyCycledMeas();
+	  while( !myPT100.isDutyCycledMeasDone() )
+	  {
+		  myPT100.dutyCycleTick(); //e.g. from the main loop
+	  }
+	  MAX31865_Snapshot_t result = myPT100.getDutyCycledResult();
+	* \endcode
+	*
+	* @returns False if a measurement or a fault detection is already running
+	*/
+	bool startDutyCycledMeas();
+
+	/**
+	* @brief Advance the duty-cycled measurement, never waits
+	*/
+	void dutyCycleTick();
+
+	/**
+	* @brief Check if the duty-cycled measurement is running (VBIAS may be on)
+	*/
+	bool isDutyCycledMeasBusy();
+
+	/**
+	* @brief Check if the result of the duty-cycled measurement is ready
+	*/
+	bool isDutyCycledMeasDone();
+
+	/**
+	* @brief Get the result of the duty-cycled measurement
+	*
+	* @returns The registers read right after the conversion, the measurement is ended
+	*/
+	MAX31865_Snapshot_t getDutyCycledResult();
 };
 
 #endif /* MODULES_MAX31865_MAX31865_HPP_ */
@@ -0,0 +1,617 @@
+/*
+ * MAX31865_Bus.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "MAX31865_Bus.hpp"
+
+MAX31865_Bus::MAX31865_Bus( SPI_HandleTypeDef *hspi_p )
+{
+	hspi = hspi_p;
+}
+
+bool MAX31865_Bus::addSensor( MAX31865* sensor_p, uint8_t measID_p )
+{
+	if( channelCount >= MAX31865_BUS_MAX_SENSORS || sensor_p == NULL || sensor_p -> getSPIHandle() != hspi )
+	{
+		return false;
+	}
+
+	channels[channelCount].sensor = sensor_p;
+	channels[channelCount].measID = measID_p;
+	channels[channelCount].pending = false;
+	channels[channelCount].result.errors = 0;
+	channels[channelCount].filter.configure(FILTER_NONE, 1);
+	channels[channelCount].calPoints = 0;
+	channelCount++;
+
+	return true;
+}
+
+HAL_StatusTypeDef MAX31865_Bus::init( MAX31865_FilterSetting_t filterSetting_p )
+{
+	HAL_StatusTypeDef stat = HAL_OK;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( channels[i].sensor -> init(filterSetting_p) != HAL_OK )
+		{
+			stat = HAL_ERROR;
+		}
+	}
+
+	return stat;
+}
+
+void MAX31865_Bus::startContinousMeas()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> startContinousMeas();
+	}
+	continuous = true;
+}
+
+void MAX31865_Bus::stopContinousMeas()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> stopContinousMeas();
+	}
+	continuous = false;
+}
+
+void MAX31865_Bus::resumeContinousMeas()
+{
+	startContinousMeas();
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		//Reading the RTD registers resets DRDY
+		if( channels[i].sensor -> isDataReady() )
+		{
+			channels[i].sensor -> getRTD();
+		}
+	}
+}
+
+void MAX31865_Bus::startDutyCycledMeas( uint8_t timeConstants_p )
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> setBiasSettling(timeConstants_p);
+		channels[i].sensor -> setBias(false);
+		channels[i].pending = false;
+	}
+	continuous = false;
+	dutyCycled = true;
+}
+
+bool MAX31865_Bus::stopDutyCycledMeas()
+{
+	bool busy = false;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		//A running measurement is finished first, so it does not overwrite the configuration
+		if( channels[i].sensor -> isDutyCycledMeasBusy() )
+		{
+			channels[i].sensor -> dutyCycleTick();
+		}
+		if( channels[i].sensor -> isDutyCycledMeasBusy() )
+		{
+			busy = true;
+		}
+		else if( channels[i].sensor -> isDutyCycledMeasDone() )
+		{
+			channels[i].sensor -> getDutyCycledResult();
+		}
+	}
+
+	if( busy )
+	{
+		return false;
+	}
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> setBias(true);
+		channels[i].pending = false;
+	}
+	dutyCycled = false;
+
+	startContinousMeas();
+
+	return true;
+}
+
+bool MAX31865_Bus::isDutyCycled()
+{
+	return dutyCycled;
+}
+
+void MAX31865_Bus::setFilter( SampleFilterType_t type_p, uint8_t param_p )
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].filter.configure(type_p, param_p);
+	}
+}
+
+void MAX31865_Bus::updateAlarmLimits( uint8_t index_p )
+{
+	//The limits are compared with the raw samples, without the fault bit
+	uint16_t low = channels[index_p].sensor -> RTDFromTemp(alarmLow) >> 1;
+	uint16_t high = channels[index_p].sensor -> RTDFromTemp(alarmHigh) >> 1;
+
+	channels[index_p].alarm.setLimits(low, high);
+}
+
+void MAX31865_Bus::setAlarmCapture( float low_p, float high_p, uint8_t pre_p, uint8_t post_p )
+{
+	alarmLow = low_p;
+	alarmHigh = high_p;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		updateAlarmLimits(i);
+		channels[i].alarm.configure(pre_p, post_p);
+	}
+}
+
+void MAX31865_Bus::disableAlarmCapture()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].alarm.disable();
+	}
+}
+
+bool MAX31865_Bus::isAlarmPending()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( channels[i].alarm.isFrozen() ) { return true; }
+	}
+	return false;
+}
+
+bool MAX31865_Bus::isAcquiring()
+{
+	if( dutyCycled )
+	{
+		return false;
+	}
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( channels[i].filter.getType() != FILTER_NONE || channels[i].alarm.getState() != ALARM_DISABLED ) { return true; }
+	}
+	return false;
+}
+
+uint8_t MAX31865_Bus::storeAlarms( MeasurementStorage* ms_p, uint16_t sinceLastLog_p )
+{
+	uint8_t stored = 0;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( !channels[i].alarm.isFrozen() )
+		{
+			continue;
+		}
+
+		uint16_t burst[ALARMCAPTURE_RING_SIZE];
+		uint8_t trigger = 0;
+		uint8_t len = channels[i].alarm.getBurst(burst, &trigger);
+
+		MeasEntry entries[MS_MAX_BATCH];
+		uint8_t entryCount = 0;
+
+		uint32_t period = channels[i].sensor -> getContinuousPeriod() / 10;
+		entries[0].measID = MS_BURST_HEADER_ID;
+		entries[0].deltaT = sinceLastLog_p;
+		entries[0].measData = ((uint32_t)channels[i].measID << 24) | ((uint32_t)trigger << 16) | (((uint32_t)channels[i].alarm.getCause() & 0xF) << 12) | (period & 0xFFF);
+		entryCount = 1;
+
+		for(uint8_t n = 0; n < len; n++)
+		{
+			float tempMeas = channels[i].sensor -> tempFromRTD(burst[n] << 1);
+
+			entries[entryCount].measID = channels[i].measID | MS_BURST_FLAG;
+			entries[entryCount].deltaT = 0;
+			memcpy(&entries[entryCount].measData, (const float*)&tempMeas, sizeof(uint32_t));
+			entryCount++;
+
+			if( entryCount == MS_MAX_BATCH || n == len - 1 )
+			{
+				ms_p -> addEntries(entries, entryCount);
+				entryCount = 0;
+			}
+		}
+
+		channels[i].sensor -> clearFaults();
+		channels[i].alarm.rearm();
+		stored++;
+	}
+
+	return stored;
+}
+
+uint8_t MAX31865_Bus::acquire()
+{
+	uint8_t newSamples = 0;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		bool filtering = channels[i].filter.getType() != FILTER_NONE;
+		bool capturing = channels[i].alarm.getState() != ALARM_DISABLED;
+
+		//In low-duty mode the only conversion is the one collected by poll()
+		if( ( !filtering && !capturing ) || dutyCycled || channels[i].sensor -> isFaultDetectionBusy() )
+		{
+			continue;
+		}
+
+		if( channels[i].sensor -> isDataReady() )
+		{
+			uint16_t rtd = channels[i].sensor -> getRTD(); //Reading the RTD registers also resets DRDY
+
+			if( ( rtd & (uint16_t) 0x1 ) == 0 ) //Samples with the fault bit set are not filtered
+			{
+				if( filtering )
+				{
+					//Processed at once, the ring only holds a few samples, not the whole period
+					channels[i].filter.push(rtd >> 1);
+					channels[i].filter.process();
+				}
+				if( capturing ) { channels[i].alarm.push(rtd >> 1); }
+				newSamples++;
+			}
+			else if( capturing )
+			{
+				//Only a threshold crossing triggers, on other faults the sample is not valid
+				uint16_t faults = channels[i].sensor -> readFaultStatus();
+
+				if( faults == HighThrehsold ) 		{ channels[i].alarm.push(rtd >> 1, ALARM_CAUSE_HIGH_THRESHOLD); }
+				else if( faults == LowThrehsold ) 	{ channels[i].alarm.push(rtd >> 1, ALARM_CAUSE_LOW_THRESHOLD); }
+			}
+		}
+	}
+
+	return newSamples;
+}
+
+void MAX31865_Bus::startConversions()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		//In continuous mode the devices are already converting, only the result has to be collected
+		if( dutyCycled )
+		{
+			if( !channels[i].sensor -> startDutyCycledMeas() ) { continue; }
+		}
+		else if( !continuous )
+		{
+			channels[i].sensor -> triggerSingleMeas();
+		}
+		channels[i].pending = true;
+	}
+}
+
+bool MAX31865_Bus::poll()
+{
+	bool allCollected = true;
+
+	//Round-robin, starting where the previous pass stopped
+	for(uint8_t n = 0; n < channelCount; n++)
+	{
+		uint8_t i = (nextChannel + n) % channelCount;
+
+		if( !channels[i].pending )
+		{
+			continue;
+		}
+
+		if( dutyCycled )
+		{
+			channels[i].sensor -> dutyCycleTick();
+
+			if( channels[i].sensor -> isDutyCycledMeasDone() )
+			{
+				channels[i].result = channels[i].sensor -> getDutyCycledResult();
+				channels[i].pending = false;
+			}
+			else
+			{
+				allCollected = false;
+			}
+		}
+		else if( channels[i].sensor -> isDataReady() )
+		{
+			channels[i].result = channels[i].sensor -> snapshot();
+			channels[i].pending = false;
+
+			//The snapshot also holds a new conversion, it is not fed in by acquire()
+			bool valid = ( channels[i].result.rtd & (uint16_t) 0x1 ) == 0;
+
+			if( valid && channels[i].alarm.getState() != ALARM_DISABLED )
+			{
+				channels[i].alarm.push(channels[i].result.rtd >> 1);
+			}
+
+			if( channels[i].filter.getType() != FILTER_NONE )
+			{
+				uint16_t filtered;
+
+				if( valid )
+				{
+					channels[i].filter.push(channels[i].result.rtd >> 1);
+				}
+
+				if( channels[i].filter.read(&filtered) )
+				{
+					channels[i].result.temperature = channels[i].sensor -> tempFromRTD(filtered << 1);
+				}
+			}
+		}
+		else
+		{
+			allCollected = false;
+		}
+	}
+
+	if(channelCount != 0)
+	{
+		nextChannel = (nextChannel + 1) % channelCount;
+	}
+
+	return allCollected;
+}
+
+uint8_t MAX31865_Bus::collect( uint32_t timeout_p )
+{
+	uint32_t start = HAL_GetTick();
+
+	while( !poll() )
+	{
+		if( (HAL_GetTick() - start) > timeout_p )
+		{
+			break;
+		}
+	}
+
+	uint8_t collected = 0;
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( !channels[i].pending ) { collected++; }
+	}
+
+	return collected;
+}
+
+uint8_t MAX31865_Bus::storeAll( MeasurementStorage* ms_p, uint16_t deltaT_p )
+{
+	MeasEntry entries[MAX31865_BUS_MAX_SENSORS];
+	uint8_t entryCount = 0;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		//Timed out channel, there is no new result to store
+		if( channels[i].pending )
+		{
+			continue;
+		}
+
+		float tempMeas = channels[i].result.temperature;
+
+		entries[entryCount].measID = channels[i].measID;
+		entries[entryCount].deltaT = (entryCount == 0) ? deltaT_p : 0; //Every channel was sampled in the same sweep
+		memcpy(&entries[entryCount].measData, (const float*)&tempMeas, sizeof(uint32_t));
+		entryCount++;
+	}
+
+	if(entryCount == 0)
+	{
+		return 0;
+	}
+
+	return ms_p -> addEntries(entries, entryCount);
+}
+
+void MAX31865_Bus::startFaultDetection( MAX31865_FaultDetectCallback callback_p, bool manual_p )
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> startFaultDetection(callback_p, manual_p);
+	}
+}
+
+void MAX31865_Bus::faultDetectionTick()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> faultDetectionTick();
+	}
+}
+
+bool MAX31865_Bus::isFaultDetectionBusy()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( channels[i].sensor -> isFaultDetectionBusy() ) { return true; }
+	}
+	return false;
+}
+
+bool MAX31865_Bus::planFaultDetection( uint32_t samplePeriod_p, uint32_t detectInterval_p, MAX31865_FaultDetectCallback callback_p )
+{
+	bool planned = true;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( !channels[i].sensor -> planFaultDetection(samplePeriod_p, detectInterval_p, callback_p) )
+		{
+			planned = false;
+		}
+	}
+
+	return planned;
+}
+
+void MAX31865_Bus::sampleTaken()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> sampleTaken();
+	}
+}
+
+uint32_t MAX31865_Bus::getFaultDetectCostPerHour()
+{
+	uint32_t cost = 0;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		uint32_t sensorCost = channels[i].sensor -> getFaultDetectCostPerHour();
+		if( sensorCost > cost ) { cost = sensorCost; }
+	}
+
+	return cost;
+}
+
+void MAX31865_Bus::setDeadbandWindows( float deadband_p )
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> setThresholdWindow(channels[i].result.temperature, deadband_p);
+	}
+}
+
+void MAX31865_Bus::clearDeadbandWindows()
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		channels[i].sensor -> clearThresholdWindow();
+	}
+}
+
+bool MAX31865_Bus::deadbandTripped()
+{
+	bool tripped = false;
+
+	//Every channel is checked, so each transaction stays short and equal
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( channels[i].sensor -> thresholdTripped() ) { tripped = true; }
+	}
+
+	return tripped;
+}
+
+int8_t MAX31865_Bus::findChannel( uint8_t measID_p )
+{
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		if( channels[i].measID == measID_p ) { return i; }
+	}
+	return -1;
+}
+
+bool MAX31865_Bus::captureCalibrationPoint( uint8_t measID_p, uint8_t point_p, float reference_p )
+{
+	int8_t i = findChannel(measID_p);
+
+	if( i < 0 || point_p < 1 || point_p > 2 )
+	{
+		return false;
+	}
+
+	//Leaving the threshold window (deadband mode) does not make the reading invalid
+	uint16_t errors = channels[i].result.errors & ~(HighThrehsold | LowThrehsold);
+
+	if( channels[i].pending || errors != 0 || ( channels[i].result.rtd & (uint16_t) 0x1 ) != 0 )
+	{
+		return false;
+	}
+
+	channels[i].calRTD[point_p - 1] = channels[i].result.rtd;
+	channels[i].calReference[point_p - 1] = reference_p;
+	channels[i].calPoints |= 1 << (point_p - 1);
+
+	return true;
+}
+
+bool MAX31865_Bus::applyCalibration( uint8_t measID_p, MeasurementStorage* ms_p )
+{
+	int8_t i = findChannel(measID_p);
+
+	if( i < 0 || channels[i].calPoints != 0b11 )
+	{
+		return false;
+	}
+
+	if( !channels[i].sensor -> calibrateTwoPoint(channels[i].calRTD[0], channels[i].calReference[0], channels[i].calRTD[1], channels[i].calReference[1]) )
+	{
+		return false;
+	}
+
+	channels[i].calPoints = 0;
+	updateAlarmLimits(i);
+
+	MAX31865_Calibration_t calibration = channels[i].sensor -> getCalibration();
+	return ms_p -> writeCalibration(i, calibration.gain, calibration.offset) == HAL_OK;
+}
+
+bool MAX31865_Bus::resetCalibration( uint8_t measID_p, MeasurementStorage* ms_p )
+{
+	int8_t i = findChannel(measID_p);
+
+	if( i < 0 )
+	{
+		return false;
+	}
+
+	MAX31865_Calibration_t calibration = { MAX31865_CAL_UNITY_GAIN, 0 };
+	channels[i].sensor -> setCalibration(calibration);
+	channels[i].calPoints = 0;
+	updateAlarmLimits(i);
+
+	//Written as an erased slot, so it is not loaded at the next start
+	return ms_p -> writeCalibration(i, -1, -1) == HAL_OK;
+}
+
+uint8_t MAX31865_Bus::loadCalibrations( MeasurementStorage* ms_p )
+{
+	uint8_t loaded = 0;
+
+	for(uint8_t i = 0; i < channelCount; i++)
+	{
+		MAX31865_Calibration_t calibration;
+
+		if( ms_p -> readCalibration(i, &calibration.gain, &calibration.offset) )
+		{
+			channels[i].sensor -> setCalibration(calibration);
+			updateAlarmLimits(i);
+			loaded++;
+		}
+	}
+
+	return loaded;
+}
+
+uint8_t MAX31865_Bus::getSensorCount()
+{
+	return channelCount;
+}
+
+const MAX31865_BusChannel_t* MAX31865_Bus::getChannel( uint8_t index_p )
+{
+	if( index_p >= channelCount )
+	{
+		return NULL;
+	}
+	return &channels[index_p];
+}
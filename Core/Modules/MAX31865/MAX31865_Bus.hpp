@@ -0,0 +1,434 @@
+/**
+ * @file MAX31865_Bus.hpp
+ * @brief Manager for several MAX31865 devices sharing one SPI bus.
+ *
+ * @details Every device has its own chip select and DRDY pin, but they all use the same SPI handle.
+ * The conversions of the devices are started back to back, so they run in parallel, then the results are collected
+ * in a single round-robin pass. This way the time needed for a sweep barely grows with the number of channels.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_MAX31865_MAX31865_BUS_HPP_
+#define MODULES_MAX31865_MAX31865_BUS_HPP_
+
+#include "MAX31865.hpp"
+#include "MS.hpp"
+#include "SampleFilter.hpp"
+#include "AlarmCapture.hpp"
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+
+/// Maximum number of devices that can be attached to one bus
+#define MAX31865_BUS_MAX_SENSORS 8
+
+/// Time after which a channel that has not become ready is given up [ms]
+#define MAX31865_BUS_TIMEOUT 200
+
+/**
+ * @struct MAX31865_BusChannel_t
+ * @brief One entry of the sensor table of \link MAX31865_Bus \endlink
+ */
+typedef struct{
+	MAX31865* sensor;				/*!< The device */
+	uint8_t measID;					/*!< The measID used when the results of this device are stored */
+	bool pending;					/*!< True while a conversion is running and the result is not yet collected */
+	MAX31865_Snapshot_t result;		/*!< The last collected result, with filtering enabled the temperature is the filtered value */
+	SampleFilter filter;			/*!< Filter stage of the conversions between two sweeps */
+	AlarmCapture alarm;				/*!< Pre-trigger capture of the conversions between two sweeps */
+	uint16_t calRTD[2];				/*!< Raw RTD readings of the captured calibration points */
+	float calReference[2];			/*!< True temperatures of the captured calibration points [C] */
+	uint8_t calPoints;				/*!< Bit n is set if calibration point n+1 has been captured */
+} MAX31865_BusChannel_t;
+
+/**
+ * @brief Class for handling several MAX31865 devices on one SPI bus
+ *
+ * Example:
+	* \code
+	GPIO CS0(CS0_GPIO_Port, CS0_Pin);
+	GPIO RDY0(RDY0_GPIO_Port, RDY0_Pin);
+	GPIO CS1(CS1_GPIO_Port, CS1_Pin);
+	GPIO RDY1(RDY1_GPIO_Port, RDY1_Pin);
+
+	MAX31865 sensor0(&hspi1, &CS0, &RDY0);
+	MAX31865 sensor1(&hspi1, &CS1, &RDY1, PT1000);
+
+	MAX31865_Bus myBus(&hspi1);
+	⋮
+	myBus.addSensor(&sensor0, 1);
+	myBus.addSensor(&sensor1, 2);
+	myBus.init();
+
+	myBus.startConversions();
+	myBus.collect();
+	myBus.storeAll(&myMS, deltaT);
+ * \endcode
+ */
+class MAX31865_Bus{
+private:
+	/**
+	 * @brief The HAL SPI handle shared by every device of the bus
+	 */
+	SPI_HandleTypeDef *hspi;
+
+	/**
+	 * @brief The table of attached devices
+	 */
+	MAX31865_BusChannel_t channels[MAX31865_BUS_MAX_SENSORS];
+
+	/**
+	 * @brief Number of attached devices
+	 */
+	uint8_t channelCount = 0;
+
+	/**
+	 * @brief The channel, where the next round-robin pass starts
+	 */
+	uint8_t nextChannel = 0;
+
+	/**
+	 * @brief True if the devices are in continuous mode, so no conversion has to be triggered
+	 */
+	bool continuous = false;
+
+	/**
+	 * @brief True if the devices keep VBIAS off between the conversions
+	 */
+	bool dutyCycled = false;
+
+	/**
+	 * @brief Limits of the alarm capture in celsius, as they were given
+	 */
+	float alarmLow = 0;
+	float alarmHigh = 0;
+
+	/**
+	 * @brief Convert the alarm limits to raw samples with the current conversion of a channel
+	 *
+	 * Called again when the calibration of the channel changes, so the limits stay at the given temperatures.
+	 */
+	void updateAlarmLimits( uint8_t index_p );
+
+	/**
+	 * @brief Find the channel of a measID
+	 *
+	 * @returns The index of the channel, or -1 if there is none
+	 */
+	int8_t findChannel( uint8_t measID_p );
+
+public:
+	/**
+	* @brief Constructor for the MAX31865_Bus class
+	*
+	* @param hspi_p the HAL spi handler that is shared by the devices
+	*/
+	MAX31865_Bus( SPI_HandleTypeDef *hspi_p );
+
+	/**
+	* @brief Attach a device to the bus
+	*
+	* @param sensor_p the device, it must use the same SPI handle as the bus
+	* @param measID_p the measID that will be used when storing the results of this device
+	*
+	* @returns False if the table is full or the device is on a different SPI bus
+	*/
+	bool addSensor( MAX31865* sensor_p, uint8_t measID_p );
+
+	/**
+	* @brief Initialize every attached device
+	*
+	* @param filterSetting_p The requred notch frequencies for the noise rejection filter
+	*
+	* @returns HAL_OK if every device was initialized successfully
+	*/
+	HAL_StatusTypeDef init( MAX31865_FilterSetting_t filterSetting_p = MAX31865_FILTER_50HZ );
+
+	/**
+	* @brief Put every attached device into continuous mode
+	*
+	* After this \link MAX31865_Bus::startConversions startConversions \endlink does not trigger single-shot measurements, only marks the channels to be collected.
+	*/
+	void startContinousMeas();
+
+	/**
+	* @brief Take every attached device out of continuous mode
+	*/
+	void stopContinousMeas();
+
+	/**
+	* @brief Put every attached device into continuous mode again after \link MAX31865_Bus::stopContinousMeas stopContinousMeas \endlink
+	*
+	* A conversion left unread from before the pause is dropped, so DRDY stays high until the first new conversion
+	* and the next sweep does not collect an old result.
+	*/
+	void resumeContinousMeas();
+
+	/**
+	* @brief Put every attached device into the low-duty mode
+	*
+	* VBIAS is turned off, and \link MAX31865_Bus::startConversions startConversions \endlink starts duty-cycled single-shot measurements,
+	* which are advanced by \link MAX31865_Bus::poll poll \endlink. Continuous mode, the filters and the alarm capture are not used in this mode.
+	*
+	* @param timeConstants_p number of input filter time constants VBIAS is on before the conversion
+	*
+	* @see MAX31865::startDutyCycledMeas
+	*/
+	void startDutyCycledMeas( uint8_t timeConstants_p = BIAS_SETTLE_TIME_CONSTANTS );
+
+	/**
+	* @brief Leave the low-duty mode, VBIAS is turned on and continuous mode is started on every attached device
+	*
+	* The function never waits: a running duty-cycled measurement is only advanced, and the mode is left
+	* once none of them is running any more. Call it repeatedly until it returns true.
+	*
+	* @returns True if the low-duty mode has been left
+	*/
+	bool stopDutyCycledMeas();
+
+	/**
+	* @brief Check if the devices are in the low-duty mode
+	*/
+	bool isDutyCycled();
+
+	/**
+	* @brief Select the filter stage of every channel
+	*
+	* With a filter other than \link FILTER_NONE \endlink, the conversions between two sweeps have to be fed in with \link MAX31865_Bus::acquire acquire \endlink,
+	* and the temperature of the collected results is the filtered value. Only useful in continuous mode.
+	*
+	* @param type_p the filter stage
+	* @param param_p window size or IIR shift, see \link SampleFilter::configure \endlink
+	*/
+	void setFilter( SampleFilterType_t type_p, uint8_t param_p );
+
+	/**
+	* @brief Enable the alarm capture on every channel
+	*
+	* Every conversion fed in with \link MAX31865_Bus::acquire acquire \endlink is recorded. A burst is captured when a conversion
+	* is outside the given limits or the device reports a High or Low Fault Threshold crossing.
+	* The limits stay at the given temperatures when a channel is calibrated later. Only useful in continuous mode.
+	*
+	* @param low_p lower limit in celsius
+	* @param high_p upper limit in celsius
+	* @param pre_p number of conversions kept from before the trigger
+	* @param post_p number of conversions recorded after the trigger
+	*/
+	void setAlarmCapture( float low_p, float high_p, uint8_t pre_p = ALARMCAPTURE_DEFAULT_PRE, uint8_t post_p = ALARMCAPTURE_DEFAULT_POST );
+
+	/**
+	* @brief Disable the alarm capture on every channel
+	*/
+	void disableAlarmCapture();
+
+	/**
+	* @brief Check if any channel has a complete alarm burst waiting to be stored
+	*/
+	bool isAlarmPending();
+
+	/**
+	* @brief Check if the conversions between the sweeps are used
+	*
+	* @returns True if any channel feeds its conversions into a filter or an alarm capture, so \link MAX31865_Bus::acquire acquire \endlink has to be called on every DRDY edge
+	*/
+	bool isAcquiring();
+
+	/**
+	* @brief Store the complete alarm bursts in the measurement storage and rearm the capture
+	*
+	* Each burst is one header entry (\link MS_BURST_HEADER_ID \endlink) followed by the samples, tagged with \link MS_BURST_FLAG \endlink.
+	* The latched threshold faults of the device are cleared, so the same crossing does not trigger again.
+	*
+	* @param ms_p the storage to be used
+	* @param sinceLastLog_p time since the last periodic entry in the time unit of the session, the last sample of the burst is taken at this time
+	*
+	* @returns The number of stored bursts
+	*/
+	uint8_t storeAlarms( MeasurementStorage* ms_p, uint16_t sinceLastLog_p );
+
+	/**
+	* @brief Feed the new conversions into the filters and the alarm captures
+	*
+	* Every device with a new conversion (DRDY low) is read out. Call it on DRDY events, it never waits.
+	* Not while a sweep is collected: reading the RTD resets DRDY, so \link MAX31865_Bus::poll poll \endlink would wait for the next conversion.
+	* The conversion of the sweep is fed in by \link MAX31865_Bus::poll poll \endlink instead.
+	*
+	* @returns The number of new samples
+	*/
+	uint8_t acquire();
+
+	/**
+	* @brief Start a conversion on every device
+	*
+	* The single-shot conversions are triggered back to back, so they overlap. In low-duty mode the duty-cycled measurements are started.
+	*/
+	void startConversions();
+
+	/**
+	* @brief Collect the finished conversions
+	*
+	* The channels are visited round-robin, every ready device is read out with a single burst.
+	* The function never waits, it can be called repeatedly from the main loop. In low-duty mode it also advances the duty-cycled measurements.
+	*
+	* @returns True when every channel has been collected
+	*/
+	bool poll();
+
+	/**
+	* @brief Wait until every channel has been collected
+	*
+	* @param timeout_p maximum time to wait in ms
+	*
+	* @returns The number of collected channels
+	*/
+	uint8_t collect( uint32_t timeout_p = MAX31865_BUS_TIMEOUT );
+
+	/**
+	* @brief Store the collected results in the measurement storage
+	*
+	* The first entry gets the given deltaT, the rest 0, as they were taken at the same time.
+	* Each entry is tagged with the measID of its channel. Channels that timed out are skipped.
+	*
+	* @param ms_p the storage to be used
+	* @param deltaT_p time since the previous sweep
+	*
+	* @returns The number of stored entries
+	*/
+	uint8_t storeAll( MeasurementStorage* ms_p, uint16_t deltaT_p );
+
+	/**
+	* @brief Start a non-blocking fault detection on every attached device
+	*
+	* @param callback_p called by each device when its detection has finished
+	* @param manual_p if true the two step manual cycle is used
+	*
+	* @see MAX31865::startFaultDetection
+	*/
+	void startFaultDetection( MAX31865_FaultDetectCallback callback_p, bool manual_p = false );
+
+	/**
+	* @brief Advance the non-blocking fault detection of every attached device
+	*/
+	void faultDetectionTick();
+
+	/**
+	* @brief Check if any attached device is running a fault detection
+	*/
+	bool isFaultDetectionBusy();
+
+	/**
+	* @brief Plan automatic fault detections into the idle time between the sweeps on every attached device
+	*
+	* @see MAX31865::planFaultDetection
+	*
+	* @returns False if a detection does not fit between two sweeps on any of the devices
+	*/
+	bool planFaultDetection( uint32_t samplePeriod_p, uint32_t detectInterval_p, MAX31865_FaultDetectCallback callback_p );
+
+	/**
+	* @brief Tell every attached device that a sweep has been logged
+	*
+	* @see MAX31865::sampleTaken
+	*/
+	void sampleTaken();
+
+	/**
+	* @brief Get how long the planned fault detections keep the bus from measuring
+	*
+	* The devices run their detections in parallel, so the largest cost is returned.
+	*
+	* @returns The cost in ms per hour
+	*/
+	uint32_t getFaultDetectCostPerHour();
+
+	/**
+	* @brief Centre the threshold window of every channel on its last collected temperature
+	*
+	* Used for change-driven logging: the devices compare every conversion with the window in hardware,
+	* so only a short fault status read is needed to know if a new value has to be stored.
+	*
+	* @param deadband_p Half width of the window in celsius
+	*
+	* @see MAX31865::setThresholdWindow
+	*/
+	void setDeadbandWindows( float deadband_p );
+
+	/**
+	* @brief Open the threshold window of every channel to the whole range and clear the latched faults
+	*
+	* Called when change-driven logging ends, so the conversions are not flagged with a threshold fault any more.
+	*
+	* @see MAX31865::clearThresholdWindow
+	*/
+	void clearDeadbandWindows();
+
+	/**
+	* @brief Check if any channel has left its threshold window
+	*
+	* @returns True if any device reports a High or Low Fault Threshold crossing
+	*/
+	bool deadbandTripped();
+
+	/**
+	* @brief Capture a calibration point of a channel
+	*
+	* The last collected raw reading of the channel is paired with the given true temperature, so the probe has to be
+	* at the reference temperature during the last sweep. Safe to call from an interrupt, there is no bus traffic.
+	*
+	* @param measID_p the measID of the channel
+	* @param point_p 1 or 2
+	* @param reference_p the true temperature in celsius
+	*
+	* @returns False if there is no such channel or point, or the last reading was not valid
+	*/
+	bool captureCalibrationPoint( uint8_t measID_p, uint8_t point_p, float reference_p );
+
+	/**
+	* @brief Calibrate a channel from its two captured points, and store the calibration in the header page of the storage
+	*
+	* The calibration is stored in the slot of the channel index, see \link MAX31865_Bus::loadCalibrations loadCalibrations \endlink.
+	*
+	* @param measID_p the measID of the channel
+	* @param ms_p the storage to be used
+	*
+	* @returns False if a point is missing or the points are not usable
+	*
+	* @see MAX31865::calibrateTwoPoint
+	*/
+	bool applyCalibration( uint8_t measID_p, MeasurementStorage* ms_p );
+
+	/**
+	* @brief Remove the calibration of a channel, also from the storage
+	*
+	* @param measID_p the measID of the channel
+	* @param ms_p the storage to be used
+	*
+	* @returns False if there is no such channel
+	*/
+	bool resetCalibration( uint8_t measID_p, MeasurementStorage* ms_p );
+
+	/**
+	* @brief Load the stored calibration of every channel, call it once after the devices have been attached
+	*
+	* @param ms_p the storage to be used
+	*
+	* @returns The number of calibrated channels
+	*/
+	uint8_t loadCalibrations( MeasurementStorage* ms_p );
+
+	/**
+	* @brief Get the number of attached devices
+	*/
+	uint8_t getSensorCount();
+
+	/**
+	* @brief Get a channel of the sensor table
+	*
+	* @param index_p index of the channel
+	*
+	* @returns Pointer to the channel or NULL if the index is out of range
+	*/
+	const MAX31865_BusChannel_t* getChannel( uint8_t index_p );
+};
+
+#endif /* MODULES_MAX31865_MAX31865_BUS_HPP_ */
@@ -8,6 +8,8 @@
 #ifndef MODULES_MAX31865_MAX31865_REGMAP_HPP_
 #define MODULES_MAX31865_MAX31865_REGMAP_HPP_
 
+#include "RegisterMap.hpp"
+
 #define MAX31865_CONFIG_REG_ADDRESS						0x00
 
 #define MAX31865_RTD_MSB_REG_ADDRESS					0x01
@@ -21,6 +23,9 @@
 
 #define MAX31865_FAULT_STATUS_REG_ADDRESS				0x07
 
+/// Number of readable registers (0x00 - 0x07), the device auto-increments the address during a burst read
+#define MAX31865_REG_COUNT								8
+
 #define MAX31865_WRITE_OFFSET_MASK						0x80
 
 
@@ -43,4 +48,35 @@
 #define FAULT_STATUS_D1									0b00000010
 #define FAULT_STATUS_D0									0b00000001
 
+//Register descriptors, the driver accesses the device through these
+
+typedef Register<MAX31865_CONFIG_REG_ADDRESS, 1, REG_READ_WRITE>			MAX31865_ConfigReg;
+typedef Register<MAX31865_RTD_MSB_REG_ADDRESS, 2, REG_READ_ONLY>			MAX31865_RTDReg;
+typedef Register<MAX31865_HIGH_FAULT_MSB_REG_ADDRESS, 2, REG_READ_WRITE>	MAX31865_HighFaultReg;
+typedef Register<MAX31865_LOW_FAULT_MSB_REG_ADDRESS, 2, REG_READ_WRITE>		MAX31865_LowFaultReg;
+typedef Register<MAX31865_FAULT_STATUS_REG_ADDRESS, 1, REG_READ_ONLY>		MAX31865_FaultStatusReg;
+
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_VBIAS_ON>											MAX31865_VBias;
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_AUTO_CONV>										MAX31865_ConversionMode;
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_ONE_SHOT, FIELD_SELF_CLEARING>					MAX31865_OneShot;
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_3_WIRE>											MAX31865_ThreeWire;
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_FAULT_DETECTION_STOP_MANUAL, FIELD_SELF_CLEARING>	MAX31865_FaultCycle;
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_REG_FAULT_STAT_CLEAR, FIELD_SELF_CLEARING>		MAX31865_FaultClear;
+typedef Field<MAX31865_ConfigReg, MAX31865_CONFIG_REG_FILTER_50Hz>									MAX31865_Filter50Hz;
+
+typedef Field<MAX31865_RTDReg, 0xFFFE>	MAX31865_RTDValue;
+typedef Field<MAX31865_RTDReg, 0x0001>	MAX31865_RTDFault;
+
+/// Values of \link MAX31865_FaultCycle \endlink (configuration register D3:D2)
+#define MAX31865_FAULTCYCLE_NONE			0b00
+#define MAX31865_FAULTCYCLE_AUTO			0b01
+#define MAX31865_FAULTCYCLE_MANUAL_START	0b10
+#define MAX31865_FAULTCYCLE_MANUAL_STOP		0b11
+
+/// Fields of the configuration register that return to 0 by themselves, they are not kept in the shadow register
+#define MAX31865_CONFIG_SELF_CLEARING FieldMask<MAX31865_OneShot, MAX31865_FaultCycle, MAX31865_FaultClear>::value
+
+/// The configuration register while a fault detection cycle runs: VBIAS on, conversions stopped
+typedef FieldUpdate<MAX31865_VBias::is<1>, MAX31865_ConversionMode::is<0>> MAX31865_FaultDetectConfig;
+
 #endif /* MODULES_MAX31865_MAX31865_REGMAP_HPP_ */
@@ -133,9 +133,10 @@ MeasurementStorage::MeasurementStorage( I2C_HandleTypeDef* I2Ccontroller_p, uint
 	this -> freePages = freePages_p;
 }
 
-void MeasurementStorage::init(uint64_t Timestamp_p)
+void MeasurementStorage::init(uint64_t Timestamp_p, uint16_t timeUnit_p)
 {
 	setTimestamp(Timestamp_p);
+	setTimeUnit(timeUnit_p);
 	resetCounter();
 
 	uint16_t maxSize = (pageLen * freePages) / MeasEntry::len;
@@ -213,6 +214,20 @@ void MeasurementStorage::setMaxSize(uint16_t maxSize_p)
 	}
 }
 
+void MeasurementStorage::setTimeUnit(uint16_t timeUnit_p)
+{
+	uint16_t errors = 0;
+	HAL_StatusTypeDef stat;
+
+	stat = write2EEPROM(I2Ccontroller, EEPROMAddress<<1, TIME_UNIT_ADDRESS, sizeof(uint16_t), (uint8_t*)&timeUnit_p, sizeof(uint16_t), HAL_MAX_DELAY);
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += I2C_error;
+		errorHandler(this, errors);
+	}
+}
+
 uint16_t MeasurementStorage::readCounter()
 {
 	uint16_t errors = 0;
@@ -247,6 +262,29 @@ uint64_t MeasurementStorage::readTimestamp()
 	return timestamp;
 }
 
+uint16_t MeasurementStorage::readTimeUnit()
+{
+	uint16_t errors = 0;
+	HAL_StatusTypeDef stat;
+	uint16_t timeUnit = 0;
+
+	stat = readFromEEPROM(I2Ccontroller, EEPROMAddress<<1, TIME_UNIT_ADDRESS, sizeof(uint16_t), (uint8_t*)&timeUnit, sizeof(uint16_t), HAL_MAX_DELAY);
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += I2C_error;
+		errorHandler(this, errors);
+	}
+
+	//Erased or never written by an older firmware
+	if( timeUnit == 0 || timeUnit == 0xFFFF )
+	{
+		timeUnit = MS_TIME_UNIT_DEFAULT;
+	}
+
+	return timeUnit;
+}
+
 uint16_t MeasurementStorage::getMaxSize()
 {
 	uint16_t errors = 0;
@@ -281,6 +319,55 @@ void MeasurementStorage::addEntry(MeasEntry MeasEntry_p)
 	incrementCounter();
 }
 
+uint8_t MeasurementStorage::addEntries(const MeasEntry* entries_p, uint8_t count_p)
+{
+	uint16_t errors = 0;
+	HAL_StatusTypeDef stat;
+
+	if(count_p > MS_MAX_BATCH) { count_p = MS_MAX_BATCH; }
+
+	uint16_t counter = readCounter();
+	uint16_t maxSize = getMaxSize();
+
+	//Only as many, as the storage can still hold
+	if(counter >= maxSize)
+	{
+		if( errorHandler != NULL)
+		{
+			errors += Overflow_write_error;
+			errorHandler(this, errors);
+		}
+		return 0;
+	}
+	if(count_p > maxSize - counter) { count_p = maxSize - counter; }
+
+	uint8_t EntryBuffer[MS_MAX_BATCH * MeasEntry::len];
+
+	for(uint8_t i = 0; i < count_p; i++)
+	{
+		uint8_t* entryStart = EntryBuffer + i*MeasEntry::len;
+		memcpy(entryStart, 										&(entries_p[i].measID), 	sizeof(uint8_t));
+		memcpy(entryStart+sizeof(uint8_t), 						&(entries_p[i].deltaT), 	sizeof(uint16_t));
+		memcpy(entryStart+sizeof(uint8_t)+sizeof(uint16_t), 	&(entries_p[i].measData), 	sizeof(uint32_t));
+	}
+
+	uint16_t EntryAddr = pageLen + (counter * MeasEntry::len);
+
+	writeMultiPage(I2Ccontroller, EEPROMAddress, EntryAddr, EntryBuffer, count_p * MeasEntry::len, pageLen);
+
+	counter += count_p;
+
+	stat = write2EEPROM(I2Ccontroller, EEPROMAddress<<1, COUNTER_ADDRESS, sizeof(uint16_t), (uint8_t*)&counter, sizeof(uint16_t), HAL_MAX_DELAY);
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += I2C_error;
+		errorHandler(this, errors);
+	}
+
+	return count_p;
+}
+
 bool MeasurementStorage::getEntryAt(uint16_t location_p, MeasEntry* entryBuffer_p)
 {
 	uint16_t errors = 0;
@@ -330,3 +417,95 @@ bool MeasurementStorage::getEntryAt(uint16_t location_p, MeasEntry* entryBuffer_
 
 	return true;
 }
+
+uint16_t MeasurementStorage::readEntries(uint16_t location_p, uint16_t count_p, uint8_t* buffer_p)
+{
+	uint16_t count = readCounter();
+
+	if(location_p >= count)
+	{
+		return 0;
+	}
+	if(count_p > count - location_p) { count_p = count - location_p; }
+
+	uint16_t EntryAddr = pageLen + (location_p * MeasEntry::len);
+
+	HAL_StatusTypeDef stat = readFromEEPROM(I2Ccontroller, EEPROMAddress<<1, EntryAddr, sizeof(uint16_t), buffer_p, count_p * MeasEntry::len, HAL_MAX_DELAY);
+
+	if( stat != HAL_OK )
+	{
+		if( errorHandler != NULL)
+		{
+			errorHandler(this, I2C_error);
+		}
+		return 0;
+	}
+
+	return count_p;
+}
+
+HAL_StatusTypeDef MeasurementStorage::writeCalibration(uint8_t slot_p, int32_t gain_p, int32_t offset_p)
+{
+	uint16_t errors = 0;
+	HAL_StatusTypeDef stat;
+
+	if(slot_p >= CALIBRATION_SLOTS)
+	{
+		return HAL_ERROR;
+	}
+
+	uint8_t slotBuffer[2*sizeof(int32_t)];
+	memcpy(slotBuffer, 					&gain_p, 	sizeof(int32_t));
+	memcpy(slotBuffer+sizeof(int32_t), 	&offset_p, 	sizeof(int32_t));
+
+	//The 8 byte slots never cross a page boundary
+	stat = write2EEPROM(I2Ccontroller, EEPROMAddress<<1, CALIBRATION_ADDRESS + slot_p*sizeof(slotBuffer), sizeof(uint16_t), slotBuffer, sizeof(slotBuffer), HAL_MAX_DELAY);
+
+	if( stat != HAL_OK && errorHandler != NULL)
+	{
+		errors += I2C_error;
+		errorHandler(this, errors);
+	}
+
+	return stat;
+}
+
+bool MeasurementStorage::readCalibration(uint8_t slot_p, int32_t* gain_p, int32_t* offset_p)
+{
+	uint16_t errors = 0;
+	HAL_StatusTypeDef stat;
+
+	if(slot_p >= CALIBRATION_SLOTS)
+	{
+		return false;
+	}
+
+	uint8_t slotBuffer[2*sizeof(int32_t)];
+
+	stat = readFromEEPROM(I2Ccontroller, EEPROMAddress<<1, CALIBRATION_ADDRESS + slot_p*sizeof(slotBuffer), sizeof(uint16_t), slotBuffer, sizeof(slotBuffer), HAL_MAX_DELAY);
+
+	if( stat != HAL_OK )
+	{
+		if( errorHandler != NULL)
+		{
+			errors += I2C_error;
+			errorHandler(this, errors);
+		}
+		return false;
+	}
+
+	int32_t gain, offset;
+	memcpy(&gain, 	slotBuffer, 					sizeof(int32_t));
+	memcpy(&offset, slotBuffer+sizeof(int32_t), 	sizeof(int32_t));
+
+	//Erased slot
+	if(gain <= 0)
+	{
+		return false;
+	}
+
+	*gain_p = gain;
+	*offset_p = offset;
+
+	return true;
+}
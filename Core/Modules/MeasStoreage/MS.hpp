@@ -26,6 +26,24 @@
 #define COUNTER_ADDRESS     8
 /// @brief EEPROM address for storing maximum size (counter is uint16, hence 2 bytes).
 #define MAX_SIZE_ADDRESS    10
+/// @brief EEPROM address for storing the time unit of deltaT in ms (maximum size is uint16, hence 2 bytes).
+#define TIME_UNIT_ADDRESS   12
+/// @brief EEPROM address of the calibration slots in the header page, not touched by MeasurementStorage::init.
+#define CALIBRATION_ADDRESS 64
+/// @brief Number of calibration slots, each holds an int32 gain and an int32 offset (8 bytes).
+#define CALIBRATION_SLOTS   8
+
+/// @brief Time unit of deltaT in ms if none is given, also used for the storages initialized before the unit was stored.
+#define MS_TIME_UNIT_DEFAULT 1000
+
+/// @brief Maximum number of entries that can be stored with one call of MeasurementStorage::addEntries.
+#define MS_MAX_BATCH        8
+
+/// @brief measID of the header entry of an alarm burst.
+/// @details deltaT: time since the previous periodic entry in the time unit of the session, measData: [31:24] measID of the channel, [23:16] index of the trigger sample, [15:12] cause, [11:0] sample period in 10 us.
+#define MS_BURST_HEADER_ID  0xFF
+/// @brief Set in the measID of the samples of an alarm burst, these entries do not advance the time (deltaT is 0).
+#define MS_BURST_FLAG       0x80
 
 // Macros for handling error codes
 /**
@@ -63,7 +81,7 @@
 struct MeasEntry
 {
     uint8_t  measID;  ///< Measurement ID.
-    uint16_t deltaT;  ///< Time delta of the measurement.
+    uint16_t deltaT;  ///< Time delta of the measurement, in the time unit of the session (see MeasurementStorage::readTimeUnit).
     uint32_t measData; ///< The actual measurement data.
     static const uint8_t len = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint32_t); ///< Length of the measurement entry.
 };
@@ -122,6 +140,7 @@ private:
     void resetCounter();
     void setTimestamp(uint64_t timestamp_p);
     void setMaxSize(uint16_t maxSize_p);
+    void setTimeUnit(uint16_t timeUnit_p);
 public:
     /**
      * @brief Constructor to initialize the MeasurementStorage class.
@@ -135,8 +154,9 @@ public:
     /**
      * @brief Initializes the measurement storage with a timestamp.
      * @param Timestamp_p The initial timestamp to set.
+     * @param timeUnit_p The time unit of deltaT in ms for this session, a finer unit allows shorter periods but a shorter largest gap (UINT16_MAX units).
      */
-    void init(uint64_t Timestamp_p);
+    void init(uint64_t Timestamp_p, uint16_t timeUnit_p = MS_TIME_UNIT_DEFAULT);
 
     /**
      * @brief Reads the current counter value.
@@ -150,6 +170,12 @@ public:
      */
     uint64_t readTimestamp();
 
+    /**
+     * @brief Reads the time unit of deltaT from EEPROM.
+     * @return The time unit in ms, \link MS_TIME_UNIT_DEFAULT \endlink if none was stored.
+     */
+    uint16_t readTimeUnit();
+
     /**
      * @brief Gets the maximum size of the storage.
      * @return The maximum number of entries that can fit into the storage.
@@ -162,6 +188,18 @@ public:
      */
     void addEntry(MeasEntry MeasEntry_p);
 
+    /**
+     * @brief Adds several measurement entries to the storage at once.
+     *
+     * The entries are written with a single multi-page write and the counter is updated only once,
+     * so storing the results of several sensors costs far less EEPROM traffic than calling \link MeasurementStorage::addEntry addEntry \endlink for each.
+     *
+     * @param entries_p Pointer to the entries to add.
+     * @param count_p Number of entries (at most \link MS_MAX_BATCH \endlink).
+     * @return The number of entries that were stored.
+     */
+    uint8_t addEntries(const MeasEntry* entries_p, uint8_t count_p);
+
     /**
      * @brief Retrieves a measurement entry at a specific location.
      * @param location_p The location of the entry to retrieve.
@@ -169,6 +207,39 @@ public:
      * @return True if the entry was retrieved successfully, false otherwise.
      */
     bool getEntryAt(uint16_t location_p, MeasEntry* entryBuffer_p);
+
+    /**
+     * @brief Reads consecutive entries as they are stored, with a single sequential read.
+     *
+     * Used for the bulk readout: the entries are copied unchanged, \link MeasEntry::len \endlink bytes each (measID, deltaT, measData, little-endian).
+     *
+     * @param location_p The location of the first entry.
+     * @param count_p The number of entries wanted.
+     * @param buffer_p Buffer of at least count_p * \link MeasEntry::len \endlink bytes.
+     * @return The number of entries read, less than count_p at the end of the stored entries.
+     */
+    uint16_t readEntries(uint16_t location_p, uint16_t count_p, uint8_t* buffer_p);
+
+    /**
+     * @brief Stores a calibration in the header page.
+     *
+     * The calibration is kept when the storage is initialized, so it belongs to the probe, not to a measurement.
+     *
+     * @param slot_p Index of the slot (less than \link CALIBRATION_SLOTS \endlink).
+     * @param gain_p The gain, 0 or less marks the slot as empty.
+     * @param offset_p The offset.
+     * @return HAL status indicating success or failure of the operation.
+     */
+    HAL_StatusTypeDef writeCalibration(uint8_t slot_p, int32_t gain_p, int32_t offset_p);
+
+    /**
+     * @brief Reads a calibration from the header page.
+     * @param slot_p Index of the slot (less than \link CALIBRATION_SLOTS \endlink).
+     * @param gain_p Where the gain is stored.
+     * @param offset_p Where the offset is stored.
+     * @return False if the slot is empty (erased EEPROM reads as a negative gain) or could not be read.
+     */
+    bool readCalibration(uint8_t slot_p, int32_t* gain_p, int32_t* offset_p);
 };
 
 /**
@@ -0,0 +1,255 @@
+/*
+ * RTClock.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "RTClock.hpp"
+
+/// Unix time of 2000-01-01 00:00:00, the start of the calendar
+static const uint64_t EPOCH_2000 = 946684800;
+
+/// Days before each month in a common year
+static const uint16_t daysBeforeMonth[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+static uint8_t fromBcd( uint32_t bcd_p )
+{
+	return (uint8_t)((bcd_p >> 4) * 10 + (bcd_p & 0x0F));
+}
+
+static uint32_t toBcd( uint32_t value_p )
+{
+	return ((value_p / 10) << 4) | (value_p % 10);
+}
+
+void RTClock::unlock()
+{
+	RTC->WPR = 0xCA;
+	RTC->WPR = 0x53;
+}
+
+void RTClock::lock()
+{
+	RTC->WPR = 0xFF;
+}
+
+void RTClock::writePrescalers()
+{
+	//The two prescalers have to be written separately
+	RTC->PRER = preDivS;
+	RTC->PRER |= (uint32_t)(RTCLOCK_PREDIV_A - 1) << RTC_PRER_PREDIV_A_Pos;
+}
+
+RTClock_Source_t RTClock::init()
+{
+	//The backup domain is write protected after reset
+	__HAL_RCC_PWR_CLK_ENABLE();
+	PWR->CR |= PWR_CR_DBP;
+
+	if( (RCC->BDCR & RCC_BDCR_RTCEN) && (RTC->ISR & RTC_ISR_INITS) )
+	{
+		//Kept running over the reset
+		source = ((RCC->BDCR & RCC_BDCR_RTCSEL) == RCC_BDCR_RTCSEL_0) ? RTCLOCK_LSE : RTCLOCK_LSI;
+		preDivS = RTC->PRER & RTC_PRER_PREDIV_S;
+		clockFrequency = (source == RTCLOCK_LSE) ? 32768 : 32000;
+
+		if( ((RTC->PRER & RTC_PRER_PREDIV_A) >> RTC_PRER_PREDIV_A_Pos) != RTCLOCK_PREDIV_A - 1 )
+		{
+			//Set up with another asynchronous prescaler (an older firmware), the calendar is kept, only the running second restarts
+			preDivS = clockFrequency / RTCLOCK_PREDIV_A - 1;
+
+			unlock();
+			RTC->ISR |= RTC_ISR_INIT;
+			while( !(RTC->ISR & RTC_ISR_INITF) );
+			writePrescalers();
+			RTC->ISR &= ~RTC_ISR_INIT;
+			lock();
+		}
+	}
+	else
+	{
+		RCC->BDCR |= RCC_BDCR_LSEON;
+		uint32_t start = HAL_GetTick();
+		while( !(RCC->BDCR & RCC_BDCR_LSERDY) && (HAL_GetTick() - start) < RTCLOCK_LSE_TIMEOUT );
+
+		if( RCC->BDCR & RCC_BDCR_LSERDY )
+		{
+			source = RTCLOCK_LSE;
+			preDivS = 1023; //32768 Hz / 32 / 1024 = 1 Hz, the subseconds are read to ~1 ms
+			clockFrequency = 32768;
+			RCC->BDCR = (RCC->BDCR & ~RCC_BDCR_RTCSEL) | RCC_BDCR_RTCSEL_0;
+		}
+		else
+		{
+			RCC->BDCR &= ~RCC_BDCR_LSEON;
+			RCC->CSR |= RCC_CSR_LSION;
+			while( !(RCC->CSR & RCC_CSR_LSIRDY) );
+
+			source = RTCLOCK_LSI;
+			preDivS = 999; //32 kHz / 32 / 1000 = 1 Hz
+			clockFrequency = 32000;
+			RCC->BDCR = (RCC->BDCR & ~RCC_BDCR_RTCSEL) | RCC_BDCR_RTCSEL_1;
+		}
+		RCC->BDCR |= RCC_BDCR_RTCEN;
+
+		unlock();
+		RTC->ISR |= RTC_ISR_INIT;
+		while( !(RTC->ISR & RTC_ISR_INITF) );
+
+		writePrescalers();
+
+		//24 hour format, read without the shadow registers
+		RTC->CR = RTC_CR_BYPSHAD;
+		RTC->TR = 0;
+		RTC->DR = (6U << RTC_DR_WDU_Pos) | (1U << RTC_DR_MU_Pos) | (1U << RTC_DR_DU_Pos); //Saturday, 2000-01-01
+
+		RTC->ISR &= ~RTC_ISR_INIT;
+		lock();
+	}
+
+	//The wakeup timer interrupt comes on the rising edge of EXTI line 22
+	EXTI->IMR |= EXTI_IMR_MR22;
+	EXTI->RTSR |= EXTI_RTSR_TR22;
+	HAL_NVIC_SetPriority(RTC_WKUP_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+	return source;
+}
+
+void RTClock::setTime( uint64_t unixTime_p )
+{
+	if( unixTime_p < EPOCH_2000 )
+	{
+		return;
+	}
+
+	uint32_t days = (uint32_t)((unixTime_p - EPOCH_2000) / 86400);
+	uint32_t seconds = (uint32_t)((unixTime_p - EPOCH_2000) % 86400);
+	uint8_t weekDay = (days + 5) % 7 + 1; //2000-01-01 was a Saturday, Monday is 1
+
+	uint32_t year = 0;
+	while( true )
+	{
+		uint32_t yearLength = (year % 4 == 0) ? 366 : 365;
+		if( days < yearLength ) { break; }
+		days -= yearLength;
+		year++;
+	}
+
+	bool leap = (year % 4 == 0);
+	uint32_t month = 12;
+	uint32_t monthStart;
+	do
+	{
+		month--;
+		monthStart = daysBeforeMonth[month] + ((leap && month >= 2) ? 1U : 0U);
+	} while( days < monthStart );
+	days -= monthStart;
+
+	uint32_t tr = (toBcd(seconds / 3600) << RTC_TR_HU_Pos) | (toBcd((seconds / 60) % 60) << RTC_TR_MNU_Pos) | (toBcd(seconds % 60) << RTC_TR_SU_Pos);
+	uint32_t dr = (toBcd(year) << RTC_DR_YU_Pos) | ((uint32_t)weekDay << RTC_DR_WDU_Pos) | (toBcd(month + 1) << RTC_DR_MU_Pos) | (toBcd(days + 1) << RTC_DR_DU_Pos);
+
+	unlock();
+	RTC->ISR |= RTC_ISR_INIT;
+	while( !(RTC->ISR & RTC_ISR_INITF) );
+	RTC->TR = tr;
+	RTC->DR = dr;
+	RTC->ISR &= ~RTC_ISR_INIT;
+	lock();
+}
+
+void RTClock::read( uint32_t* ssr_p, uint32_t* tr_p, uint32_t* dr_p )
+{
+	//The registers are read again if a counter stepped in between
+	do
+	{
+		*ssr_p = RTC->SSR;
+		*tr_p = RTC->TR;
+		*dr_p = RTC->DR;
+	} while( *ssr_p != RTC->SSR || *tr_p != RTC->TR || *dr_p != RTC->DR );
+}
+
+uint64_t RTClock::getTime()
+{
+	return getTimeMs() / 1000;
+}
+
+uint64_t RTClock::getTimeMs()
+{
+	uint32_t ssr, tr, dr;
+	read(&ssr, &tr, &dr);
+
+	uint32_t year = fromBcd((dr & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos);
+	uint32_t month = fromBcd((dr & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos);
+	uint32_t day = fromBcd((dr & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos);
+
+	uint32_t days = 365 * year + (year + 3) / 4 + daysBeforeMonth[month - 1] + day - 1;
+	if( year % 4 == 0 && month > 2 ) { days++; }
+
+	uint32_t seconds = fromBcd((tr & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos) * 3600
+			+ fromBcd((tr & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos) * 60
+			+ fromBcd((tr & (RTC_TR_ST | RTC_TR_SU)) >> RTC_TR_SU_Pos);
+
+	//The subsecond counter counts down from the prescaler
+	uint32_t ms = (preDivS - (ssr & RTC_SSR_SS)) * 1000 / (preDivS + 1);
+
+	return (EPOCH_2000 + (uint64_t)days * 86400 + seconds) * 1000 + ms;
+}
+
+bool RTClock::startWakeup( uint32_t period_p )
+{
+	if( period_p == 0 || period_p > (uint32_t)RTCLOCK_MAX_WAKEUP * 1000 )
+	{
+		return false;
+	}
+
+	uint32_t counter;
+	uint32_t clockSelect;
+	if( period_p % 1000 != 0 && period_p <= RTCLOCK_MAX_FAST_WAKEUP )
+	{
+		//RTC clock / 16
+		counter = (period_p * (clockFrequency / 16) + 500) / 1000;
+		clockSelect = 0;
+	}
+	else
+	{
+		//The 1 Hz calendar clock
+		counter = (period_p + 500) / 1000;
+		clockSelect = RTC_CR_WUCKSEL_2;
+	}
+	if( counter == 0 ) { counter = 1; }
+
+	unlock();
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	while( !(RTC->ISR & RTC_ISR_WUTWF) );
+
+	//The counter reloads itself
+	RTC->WUTR = counter - 1;
+	RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | clockSelect;
+	clearWakeup();
+	RTC->CR |= RTC_CR_WUTIE | RTC_CR_WUTE;
+	lock();
+
+	return true;
+}
+
+void RTClock::stopWakeup()
+{
+	unlock();
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	lock();
+	clearWakeup();
+}
+
+void RTClock::clearWakeup()
+{
+	//The flags are cleared by writing 0, the INIT bit is kept
+	RTC->ISR = (~(RTC_ISR_WUTF | RTC_ISR_INIT) & 0x0000FFFF) | (RTC->ISR & RTC_ISR_INIT);
+	EXTI->PR = EXTI_PR_PR22;
+}
+
+RTClock_Source_t RTClock::getSource()
+{
+	return source;
+}
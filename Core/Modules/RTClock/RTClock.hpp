@@ -0,0 +1,147 @@
+/**
+ * @file RTClock.hpp
+ * @brief Calendar and wakeup timer of the RTC, set up on register level.
+ *
+ * @details The RTC runs in the backup domain from the LSE (32.768 kHz crystal), or from the LSI if the crystal does not start.
+ * It keeps running in STOP mode and over a reset, so it is the timebase of the samples: the wakeup timer brings the MCU out of STOP
+ * at the sample time and the time of an entry is read from the calendar instead of counting timer interrupts.
+ * The calendar holds UTC, it is read and set as unix time.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_RTCLOCK_RTCLOCK_HPP_
+#define MODULES_RTCLOCK_RTCLOCK_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+
+/// Time the LSE has to start before the LSI is used instead [ms]
+#define RTCLOCK_LSE_TIMEOUT 2000
+
+/// Asynchronous prescaler of the RTC clock, a smaller one gives finer subseconds for a bit more current
+#define RTCLOCK_PREDIV_A 32
+
+/// Longest wakeup period counted from the 1 Hz calendar clock [s], the wakeup counter has 16 bits
+#define RTCLOCK_MAX_WAKEUP 65536
+
+/// Longest wakeup period counted from the RTC clock / 16 [ms], the shorter and fractional periods are counted so
+#define RTCLOCK_MAX_FAST_WAKEUP 32000
+
+/**
+ * @enum RTClock_Source_t
+ * @brief Clock of the RTC
+ */
+typedef enum{
+	RTCLOCK_LSE,	//32.768 kHz crystal, a few ppm
+	RTCLOCK_LSI,	//Internal RC, only a few percent, used if the crystal does not start
+} RTClock_Source_t;
+
+/**
+ * @brief Class of the RTC
+ *
+ * The wakeup interrupt comes on EXTI line 22, its handler has to call \link RTClock::clearWakeup clearWakeup \endlink.
+ *
+ * Example:
+	* \code
+	RTClock myClock;
+
+	void RTC_WKUP_IRQHandler(void)
+	{
+		myClock.clearWakeup();
+		//the period elapsed
+	}
+	⋮
+	myClock.init();
+	myClock.setTime(1760745600);
+	myClock.startWakeup(60000);
+	HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+ * \endcode
+ */
+class RTClock{
+private:
+	RTClock_Source_t source = RTCLOCK_LSI;	///< Clock of the RTC
+	uint16_t preDivS = 0;					///< Synchronous prescaler, the subsecond counter counts down from it
+	uint32_t clockFrequency = 32000;		///< Frequency of the RTC clock [Hz]
+
+	/**
+	 * @brief Remove the write protection of the RTC registers
+	 */
+	void unlock();
+
+	/**
+	 * @brief Write protect the RTC registers again
+	 */
+	void lock();
+
+	/**
+	 * @brief Write \link RTClock::preDivS preDivS \endlink and \link RTCLOCK_PREDIV_A \endlink into the prescaler register, only in initialization mode
+	 */
+	void writePrescalers();
+
+	/**
+	 * @brief Read the calendar and the subsecond counter as one consistent snapshot
+	 *
+	 * The shadow registers are bypassed, so they do not have to be synchronised after STOP mode.
+	 */
+	void read( uint32_t* ssr_p, uint32_t* tr_p, uint32_t* dr_p );
+
+public:
+	/**
+	 * @brief Start the RTC clock and the calendar
+	 *
+	 * If the RTC is already running (the backup domain kept it over a reset) only the settings are read back, the time is not lost.
+	 * A prescaler set up differently is written again, then only the running second restarts.
+	 * Else the LSE is started, with the LSI as fallback, and the calendar is set to 2000-01-01.
+	 *
+	 * @returns The clock of the RTC
+	 */
+	RTClock_Source_t init();
+
+	/**
+	 * @brief Set the calendar
+	 *
+	 * @param unixTime_p UTC seconds since 1970, in the years 2000-2099, an earlier time is ignored
+	 */
+	void setTime( uint64_t unixTime_p );
+
+	/**
+	 * @brief Get the time in seconds since 1970
+	 */
+	uint64_t getTime();
+
+	/**
+	 * @brief Get the time in milliseconds since 1970
+	 */
+	uint64_t getTimeMs();
+
+	/**
+	 * @brief Start the wakeup timer, its interrupt comes every period until it is stopped
+	 *
+	 * Whole seconds are counted from the calendar clock, so the interrupts do not drift from the calendar.
+	 * The other periods up to \link RTCLOCK_MAX_FAST_WAKEUP \endlink are counted from the RTC clock / 16 (~0.5 ms steps),
+	 * the longer ones are rounded to seconds.
+	 *
+	 * @param period_p 1..\link RTCLOCK_MAX_WAKEUP \endlink * 1000 ms
+	 *
+	 * @returns False if the period is out of range
+	 */
+	bool startWakeup( uint32_t period_p );
+
+	/**
+	 * @brief Stop the wakeup timer
+	 */
+	void stopWakeup();
+
+	/**
+	 * @brief Clear the wakeup flag and the EXTI line, called from the RTC_WKUP interrupt
+	 */
+	void clearWakeup();
+
+	/**
+	 * @brief Get the clock of the RTC
+	 */
+	RTClock_Source_t getSource();
+};
+
+#endif /* MODULES_RTCLOCK_RTCLOCK_HPP_ */
@@ -0,0 +1,222 @@
+/**
+ * @file RegisterMap.hpp
+ * @brief Compile-time description of device registers and their bitfields.
+ *
+ * @details A register is described by its address, width and access type, a field by its register and mask.
+ * Every helper is constexpr, so reading or writing a field compiles to the same masking and shifting that would be written by hand,
+ * while mistakes (a value that does not fit into its field, writing a read-only register, overlapping fields in one update)
+ * are caught by the compiler. Several fields of the same register can be updated together with \link FieldUpdate \endlink,
+ * so the new register value is computed once and written with a single transaction.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_REGISTERMAP_REGISTERMAP_HPP_
+#define MODULES_REGISTERMAP_REGISTERMAP_HPP_
+
+#include <stdint.h>
+
+/**
+ * @enum RegAccess_t
+ * @brief Access type of a register.
+ */
+typedef enum{
+	REG_READ_ONLY,		/*!< Can only be read */
+	REG_READ_WRITE,		/*!< Can be read and written */
+} RegAccess_t;
+
+/**
+ * @enum FieldKind_t
+ * @brief Behaviour of a field after it was written.
+ */
+typedef enum{
+	FIELD_NORMAL,			/*!< Keeps the written value */
+	FIELD_SELF_CLEARING,	/*!< Returns to 0 by itself (e.g. a command bit), it is not kept in a shadow copy */
+} FieldKind_t;
+
+/**
+ * @brief The unsigned type holding a register of the given width in bytes
+ */
+template<uint8_t Width_p> struct RegValue;
+template<> struct RegValue<1> { typedef uint8_t type; };
+template<> struct RegValue<2> { typedef uint16_t type; };
+template<> struct RegValue<4> { typedef uint32_t type; };
+
+/**
+ * @brief Position of the lowest set bit of a mask
+ */
+template<typename T>
+constexpr uint8_t lowestSetBit( T mask_p, uint8_t pos_p = 0 )
+{
+	return ( mask_p == 0 || ( mask_p & 1 ) != 0 ) ? pos_p : lowestSetBit<T>( mask_p >> 1, pos_p + 1 );
+}
+
+/**
+ * @brief Description of a register
+ *
+ * @tparam Address_p address of the (first byte of the) register
+ * @tparam Width_p width in bytes, multi-byte registers are transferred MSB first
+ * @tparam Access_p access type
+ */
+template<uint8_t Address_p, uint8_t Width_p, RegAccess_t Access_p>
+struct Register{
+	typedef typename RegValue<Width_p>::type value_t;	///< Type of the register value
+
+	static constexpr uint8_t address = Address_p;
+	static constexpr uint8_t width = Width_p;
+	static constexpr RegAccess_t access = Access_p;
+	static constexpr bool writable = ( Access_p != REG_READ_ONLY );
+
+	/**
+	 * @brief Assemble the register value from the bytes read from the device, MSB first
+	 */
+	static value_t fromBytes( const uint8_t* bytes_p )
+	{
+		value_t value = 0;
+		for(uint8_t i = 0; i < width; i++) { value = ( value << 8 ) | bytes_p[i]; }
+		return value;
+	}
+
+	/**
+	 * @brief Split the register value into bytes to be written to the device, MSB first
+	 */
+	static void toBytes( value_t value_p, uint8_t* bytes_p )
+	{
+		for(uint8_t i = 0; i < width; i++) { bytes_p[width - 1 - i] = (uint8_t)( value_p >> (8 * i) ); }
+	}
+};
+
+/**
+ * @brief A compile-time value of a field, see \link Field::is \endlink
+ */
+template<typename Field_p, typename Field_p::value_t Value_p>
+struct FieldValue{
+	typedef Field_p field;
+	typedef typename Field_p::reg reg;
+	typedef typename Field_p::value_t value_t;
+
+	static_assert( ( ( Value_p << Field_p::shift ) & ~Field_p::mask ) == 0, "The value does not fit into the field" );
+
+	static constexpr value_t mask = Field_p::mask;											///< Bits changed by this value
+	static constexpr value_t bits = (value_t)( Value_p << Field_p::shift );					///< The value at its place in the register
+	static constexpr value_t selfClearing = ( Field_p::kind == FIELD_SELF_CLEARING ) ? Field_p::mask : 0;
+};
+
+/**
+ * @brief Description of a bitfield of a register
+ *
+ * @tparam Reg_p the register of the field
+ * @tparam Mask_p the bits of the field in the register (contiguous)
+ * @tparam Kind_p if the field clears itself after it was written
+ */
+template<typename Reg_p, typename Reg_p::value_t Mask_p, FieldKind_t Kind_p = FIELD_NORMAL>
+struct Field{
+	typedef Reg_p reg;
+	typedef typename Reg_p::value_t value_t;
+
+	static_assert( Mask_p != 0, "Empty field" );
+
+	static constexpr value_t mask = Mask_p;
+	static constexpr uint8_t shift = lowestSetBit<value_t>(Mask_p);
+	static constexpr FieldKind_t kind = Kind_p;
+
+	/**
+	 * @brief The field value in the given register value
+	 */
+	static constexpr value_t get( value_t regValue_p )
+	{
+		return (value_t)( ( regValue_p & mask ) >> shift );
+	}
+
+	/**
+	 * @brief The register value with the field replaced, for values known only at runtime
+	 */
+	static constexpr value_t set( value_t regValue_p, value_t fieldValue_p )
+	{
+		return (value_t)( ( regValue_p & ~mask ) | ( ( fieldValue_p << shift ) & mask ) );
+	}
+
+	/**
+	 * @brief A compile-time value of the field, to be used in \link FieldUpdate \endlink
+	 */
+	template<value_t Value_p>
+	using is = FieldValue< Field, Value_p >;
+};
+
+/**
+ * @brief Several fields of one register updated together
+ *
+ * The masks and bits of the values are merged at compile time, so \link FieldUpdate::apply apply \endlink is a single AND and OR.
+ *
+ * Example:
+	* \code
+	typedef Register<0x00, 1, REG_READ_WRITE> ConfigReg;
+	typedef Field<ConfigReg, 0x80> Enable;
+	typedef Field<ConfigReg, 0x0C> Mode;
+
+	uint8_t newValue = FieldUpdate< Enable::is<1>, Mode::is<2> >::apply(shadow);
+	* \endcode
+ */
+template<typename... Values_p> struct FieldUpdate;
+
+template<typename Value_p>
+struct FieldUpdate<Value_p>{
+	typedef typename Value_p::reg reg;
+	typedef typename Value_p::value_t value_t;
+
+	static_assert( reg::writable, "The register is read-only" );
+
+	static constexpr value_t mask = Value_p::mask;
+	static constexpr value_t bits = Value_p::bits;
+	static constexpr value_t selfClearing = Value_p::selfClearing;
+
+	/**
+	 * @brief The register value after the update
+	 */
+	static constexpr value_t apply( value_t regValue_p )
+	{
+		return (value_t)( ( regValue_p & ~mask ) | bits );
+	}
+};
+
+template<typename Value_p, typename... Rest_p>
+struct FieldUpdate<Value_p, Rest_p...>{
+	typedef typename Value_p::reg reg;
+	typedef typename Value_p::value_t value_t;
+	typedef FieldUpdate<Rest_p...> rest;
+
+	static_assert( reg::address == rest::reg::address, "Every field of an update has to be in the same register" );
+	static_assert( ( Value_p::mask & rest::mask ) == 0, "A field is set twice in one update" );
+
+	static constexpr value_t mask = Value_p::mask | rest::mask;
+	static constexpr value_t bits = Value_p::bits | rest::bits;
+	static constexpr value_t selfClearing = Value_p::selfClearing | rest::selfClearing;
+
+	/**
+	 * @brief The register value after the update
+	 */
+	static constexpr value_t apply( value_t regValue_p )
+	{
+		return (value_t)( ( regValue_p & ~mask ) | bits );
+	}
+};
+
+/**
+ * @brief Mask of several fields of one register, e.g. every self-clearing field
+ */
+template<typename... Fields_p> struct FieldMask;
+
+template<typename Field_p>
+struct FieldMask<Field_p>{
+	static constexpr uint8_t reg_address = Field_p::reg::address;
+	static constexpr typename Field_p::value_t value = Field_p::mask;
+};
+
+template<typename Field_p, typename... Rest_p>
+struct FieldMask<Field_p, Rest_p...>{
+	static_assert( Field_p::reg::address == FieldMask<Rest_p...>::reg_address, "Every field has to be in the same register" );
+	static constexpr uint8_t reg_address = Field_p::reg::address;
+	static constexpr typename Field_p::value_t value = Field_p::mask | FieldMask<Rest_p...>::value;
+};
+
+#endif /* MODULES_REGISTERMAP_REGISTERMAP_HPP_ */
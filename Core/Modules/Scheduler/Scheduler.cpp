@@ -0,0 +1,142 @@
+/*
+ * Scheduler.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "Scheduler.hpp"
+
+void Scheduler::init()
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+bool Scheduler::attach( uint8_t type_p, Scheduler_EventHandler handler_p )
+{
+	if( type_p >= SCHEDULER_MAX_EVENTS )
+	{
+		return false;
+	}
+
+	handlers[type_p] = handler_p;
+	return true;
+}
+
+void Scheduler::setPollHook( Scheduler_Hook hook_p )
+{
+	pollHook = hook_p;
+}
+
+void Scheduler::setIdleHook( Scheduler_Hook hook_p )
+{
+	idleHook = hook_p;
+}
+
+bool Scheduler::post( uint8_t type_p, uint32_t arg_p )
+{
+	uint8_t next = (head + 1) & (SCHEDULER_QUEUE_SIZE - 1);
+
+	if( next == tail )
+	{
+		dropped++;
+		return false;
+	}
+
+	queue[head].type = type_p;
+	queue[head].arg = arg_p;
+	queue[head].stamp = DWT->CYCCNT;
+
+	//The entry has to be complete before the consumer can see it
+	__DMB();
+	head = next;
+
+	return true;
+}
+
+uint8_t Scheduler::dispatch()
+{
+	uint8_t dispatched = 0;
+
+	while( tail != head )
+	{
+		__DMB();
+		Scheduler_Event_t event = queue[tail];
+		uint32_t latency = DWT->CYCCNT - event.stamp;
+
+		//The slot is given back before the handler runs, so the handler can be interrupted by new posts
+		tail = (tail + 1) & (SCHEDULER_QUEUE_SIZE - 1);
+
+		if( event.type < SCHEDULER_MAX_EVENTS )
+		{
+			stats[event.type].count++;
+			stats[event.type].lastLatency = latency;
+			if( latency > stats[event.type].maxLatency ) { stats[event.type].maxLatency = latency; }
+
+			if( handlers[event.type] != NULL )
+			{
+				handlers[event.type](event.arg);
+			}
+		}
+
+		dispatched++;
+	}
+
+	return dispatched;
+}
+
+void Scheduler::runOnce()
+{
+	dispatch();
+
+	if( pollHook != NULL )
+	{
+		pollHook();
+	}
+
+	//Masked, so an interrupt between the check and the WFI is not lost: it stays pending and wakes the MCU up at once
+	__disable_irq();
+	if( isEmpty() && idleHook != NULL )
+	{
+		idleHook();
+	}
+	__enable_irq();
+}
+
+bool Scheduler::isEmpty()
+{
+	return tail == head;
+}
+
+Scheduler_Stats_t Scheduler::getStats( uint8_t type_p )
+{
+	if( type_p >= SCHEDULER_MAX_EVENTS )
+	{
+		Scheduler_Stats_t empty = {0, 0, 0};
+		return empty;
+	}
+	return stats[type_p];
+}
+
+uint32_t Scheduler::getMaxLatencyUs( uint8_t type_p )
+{
+	return getStats(type_p).maxLatency / (SystemCoreClock / 1000000);
+}
+
+uint32_t Scheduler::getDropped()
+{
+	return dropped;
+}
+
+void Scheduler::resetStats()
+{
+	for(uint8_t i = 0; i < SCHEDULER_MAX_EVENTS; i++)
+	{
+		stats[i].count = 0;
+		stats[i].lastLatency = 0;
+		stats[i].maxLatency = 0;
+	}
+	dropped = 0;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file Scheduler.hpp
+ * @brief Event-driven cooperative scheduler with static memory.
+ *
+ * @details The interrupts only post an event into a lock-free single-producer single-consumer queue and return.
+ * The events are dispatched in the main context, each handler runs to completion, so the handlers never preempt each other
+ * and can use the SPI and I2C buses freely. When the queue is empty a poll hook advances the work that is timed by polling,
+ * then the idle hook puts the MCU to sleep until the next interrupt.
+ * The time from posting an event to the start of its handler is measured with the DWT cycle counter.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_SCHEDULER_SCHEDULER_HPP_
+#define MODULES_SCHEDULER_SCHEDULER_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+
+/// Number of events the queue can hold (must be a power of two)
+#define SCHEDULER_QUEUE_SIZE 16
+
+/// Number of different event types
+#define SCHEDULER_MAX_EVENTS 8
+
+/**
+ * @typedef Scheduler_EventHandler
+ * @brief Handler of an event, called in the main context with the argument given when the event was posted.
+ */
+typedef void(*Scheduler_EventHandler)( uint32_t arg_p );
+
+/**
+ * @typedef Scheduler_Hook
+ * @brief Poll or idle hook of the scheduler.
+ */
+typedef void(*Scheduler_Hook)( void );
+
+/**
+ * @struct Scheduler_Event_t
+ * @brief One entry of the event queue
+ */
+typedef struct{
+	uint8_t type;		/*!< The event type, the index of its handler */
+	uint32_t arg;		/*!< Argument of the handler */
+	uint32_t stamp;		/*!< DWT cycle counter when the event was posted */
+} Scheduler_Event_t;
+
+/**
+ * @struct Scheduler_Stats_t
+ * @brief Dispatch statistics of an event type
+ */
+typedef struct{
+	uint32_t count;			/*!< Number of dispatched events */
+	uint32_t lastLatency;	/*!< Latency of the last event [cycles] */
+	uint32_t maxLatency;	/*!< Largest latency [cycles] */
+} Scheduler_Stats_t;
+
+/**
+ * @brief Class of the scheduler
+ *
+ * The producer side of the queue is the interrupt context. Every interrupt of the application has the same priority,
+ * so they do not preempt each other and act as a single producer. The main context is the only consumer.
+ *
+ * Example:
+	* \code
+	Scheduler myScheduler;
+
+	void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+	{
+		myScheduler.post(EVENT_TICK);
+	}
+
+	void onTick(uint32_t arg_p)
+	{
+		//runs in the main context
+	}
+	⋮
+	myScheduler.init();
+	myScheduler.attach(EVENT_TICK, onTick);
+	myScheduler.setIdleHook(enterSleep);
+
+	while(1)
+	{
+		myScheduler.runOnce();
+	}
+ * \endcode
+ */
+class Scheduler{
+private:
+	Scheduler_Event_t queue[SCHEDULER_QUEUE_SIZE];		///< The event queue
+	volatile uint8_t head = 0;							///< Written by the producer, where the next event is posted
+	volatile uint8_t tail = 0;							///< Written by the consumer, the next event to dispatch
+
+	Scheduler_EventHandler handlers[SCHEDULER_MAX_EVENTS] = {};	///< Handler of each event type
+	Scheduler_Stats_t stats[SCHEDULER_MAX_EVENTS] = {};			///< Statistics of each event type
+	volatile uint32_t dropped = 0;								///< Events lost because the queue was full
+
+	Scheduler_Hook pollHook = NULL;		///< Called on every pass
+	Scheduler_Hook idleHook = NULL;		///< Called when there is nothing to do, with the interrupts masked
+
+public:
+	/**
+	 * @brief Enable the DWT cycle counter used for the latency measurement
+	 */
+	void init();
+
+	/**
+	 * @brief Attach the handler of an event type
+	 *
+	 * @returns False if the type is out of range
+	 */
+	bool attach( uint8_t type_p, Scheduler_EventHandler handler_p );
+
+	/**
+	 * @brief Set the hook called on every pass of \link Scheduler::runOnce runOnce \endlink, after the events have been dispatched
+	 *
+	 * Used for the work that is timed by polling, it must not wait.
+	 */
+	void setPollHook( Scheduler_Hook hook_p );
+
+	/**
+	 * @brief Set the hook called when the queue is empty
+	 *
+	 * The hook is called with the interrupts masked, so an event posted after the queue was checked still wakes up the MCU
+	 * from a WFI inside the hook. It should only enter sleep (or return if the poll hook still has work to do).
+	 */
+	void setIdleHook( Scheduler_Hook hook_p );
+
+	/**
+	 * @brief Post an event, called from an interrupt
+	 *
+	 * @param type_p the event type
+	 * @param arg_p argument of the handler
+	 *
+	 * @returns False if the queue was full and the event was dropped
+	 */
+	bool post( uint8_t type_p, uint32_t arg_p = 0 );
+
+	/**
+	 * @brief Dispatch every queued event
+	 *
+	 * @returns The number of dispatched events
+	 */
+	uint8_t dispatch();
+
+	/**
+	 * @brief One pass of the main loop: dispatch the events, call the poll hook and sleep if there is nothing to do
+	 */
+	void runOnce();
+
+	/**
+	 * @brief Check if no event is waiting
+	 */
+	bool isEmpty();
+
+	/**
+	 * @brief Get the dispatch statistics of an event type
+	 */
+	Scheduler_Stats_t getStats( uint8_t type_p );
+
+	/**
+	 * @brief Get the largest latency of an event type in us
+	 */
+	uint32_t getMaxLatencyUs( uint8_t type_p );
+
+	/**
+	 * @brief Get the number of events lost because the queue was full
+	 */
+	uint32_t getDropped();
+
+	/**
+	 * @brief Clear the statistics and the drop counter
+	 */
+	void resetStats();
+};
+
+#endif /* MODULES_SCHEDULER_SCHEDULER_HPP_ */
@@ -0,0 +1,110 @@
+/**
+ * @file Sensor.hpp
+ * @brief Common interface of the sensor drivers, resolved at compile time.
+ *
+ * @details A driver derives from Sensor<Driver> and implements the sensor... functions, the calls of the base are
+ * forwarded to them with a static_cast. There are no virtual functions, so every call is known at compile time and
+ * can be inlined, and no vtable or heap is needed. Code that works with any sensor takes a Sensor<Driver>& and is a template.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_SENSOR_SENSOR_HPP_
+#define MODULES_SENSOR_SENSOR_HPP_
+
+#include <stdint.h>
+
+/**
+ * @struct SensorReading_t
+ * @brief One collected sample of a sensor
+ */
+typedef struct{
+	uint32_t raw;		/*!< The raw value as read from the device */
+	float value;		/*!< The converted value, in the unit of the sensor */
+	uint16_t errors;	/*!< Error flags of the driver, 0 if the sample is valid */
+} SensorReading_t;
+
+/**
+ * @brief Base of the sensor drivers
+ *
+ * The driver has to implement the following functions, they can be private if Sensor<Driver> is a friend:
+ * - void sensorStart() : start a conversion (nothing to do if the device converts continuously)
+ * - bool sensorReady() : true if a new conversion can be read, must not wait
+ * - uint32_t sensorReadRaw() : read the last conversion
+ * - float sensorConvert(uint32_t raw) : convert a raw value
+ * - uint16_t sensorFaultStatus(uint32_t raw) : error flags of a raw value, 0 if it is valid
+ *
+ * Example:
+	* \code
+	class MyADC : public Sensor<MyADC>{
+		friend class Sensor<MyADC>;
+	private:
+		void sensorStart();
+		bool sensorReady();
+		uint32_t sensorReadRaw();
+		float sensorConvert(uint32_t raw_p);
+		uint16_t sensorFaultStatus(uint32_t raw_p);
+	};
+
+	template<typename Driver_p>
+	float measure( Sensor<Driver_p>& sensor_p )
+	{
+		sensor_p.start();
+		while( !sensor_p.ready() );
+		return sensor_p.convert(sensor_p.readRaw());
+	}
+ * \endcode
+ */
+template<typename Driver_p>
+class Sensor{
+private:
+	Driver_p& driver() { return *static_cast<Driver_p*>(this); }
+
+protected:
+	/**
+	 * @brief Only a driver can be constructed
+	 */
+	Sensor() {}
+
+public:
+	/**
+	 * @brief Start a conversion
+	 */
+	void start() { driver().sensorStart(); }
+
+	/**
+	 * @brief Check if a new conversion can be read
+	 */
+	bool ready() { return driver().sensorReady(); }
+
+	/**
+	 * @brief Read the last conversion
+	 */
+	uint32_t readRaw() { return driver().sensorReadRaw(); }
+
+	/**
+	 * @brief Convert a raw value into the unit of the sensor
+	 */
+	float convert( uint32_t raw_p ) { return driver().sensorConvert(raw_p); }
+
+	/**
+	 * @brief Get the error flags of a raw value
+	 *
+	 * @returns 0 if the value is valid
+	 */
+	uint16_t faultStatus( uint32_t raw_p ) { return driver().sensorFaultStatus(raw_p); }
+
+	/**
+	 * @brief Read the last conversion with its value and error flags
+	 */
+	SensorReading_t read()
+	{
+		SensorReading_t reading;
+		reading.raw = readRaw();
+		reading.errors = faultStatus(reading.raw);
+		reading.value = convert(reading.raw);
+		return reading;
+	}
+};
+
+#endif /* MODULES_SENSOR_SENSOR_HPP_ */
@@ -0,0 +1,188 @@
+/**
+ * @file SensorList.hpp
+ * @brief Compile-time list of the sensors sampled in one sweep of the station.
+ *
+ * @details The list is a recursive template, so a sweep over it unrolls into direct calls of every member,
+ * without virtual dispatch, function pointers or heap. A member can be anything with the following functions:
+ * - void startConversions() : start the conversions of the member
+ * - bool poll() : collect the finished conversions without waiting, true if every one was collected
+ * - uint8_t storeAll(MeasurementStorage* ms, uint16_t deltaT) : store the collected results, returns the number of entries
+ *
+ * \link MAX31865_Bus \endlink is such a member, and a single driver implementing \link Sensor \endlink
+ * can be added with the \link SensorChannel \endlink adapter.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_SENSOR_SENSORLIST_HPP_
+#define MODULES_SENSOR_SENSORLIST_HPP_
+
+#include "Sensor.hpp"
+#include "MS.hpp"
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief One sensor driver as a member of a \link SensorList \endlink
+ *
+ * Example:
+	* \code
+	MyADC myADC;
+	SensorChannel<MyADC> adcChannel(myADC, 5);
+	* \endcode
+ */
+template<typename Driver_p>
+class SensorChannel{
+private:
+	Sensor<Driver_p>& sensor;	///< The driver
+	uint8_t measID;				///< The measID used when the results are stored
+	bool pending = false;		///< True while a conversion is running and the result is not yet collected
+	SensorReading_t result;		///< The last collected result
+
+public:
+	/**
+	 * @brief Constructor for the SensorChannel class
+	 *
+	 * @param sensor_p the driver
+	 * @param measID_p the measID used when the results are stored
+	 */
+	SensorChannel( Sensor<Driver_p>& sensor_p, uint8_t measID_p ) : sensor(sensor_p), measID(measID_p)
+	{
+		result.raw = 0;
+		result.value = 0;
+		result.errors = 0;
+	}
+
+	/**
+	 * @brief Start a conversion
+	 */
+	void startConversions()
+	{
+		sensor.start();
+		pending = true;
+	}
+
+	/**
+	 * @brief Collect the conversion if it has finished, never waits
+	 *
+	 * @returns True if the result has been collected
+	 */
+	bool poll()
+	{
+		if( pending && sensor.ready() )
+		{
+			result = sensor.read();
+			pending = false;
+		}
+		return !pending;
+	}
+
+	/**
+	 * @brief Store the collected result, nothing is stored if it timed out
+	 *
+	 * @returns The number of stored entries
+	 */
+	uint8_t storeAll( MeasurementStorage* ms_p, uint16_t deltaT_p )
+	{
+		if( pending )
+		{
+			return 0;
+		}
+
+		MeasEntry entry;
+		entry.measID = measID;
+		entry.deltaT = deltaT_p;
+		memcpy(&entry.measData, (const float*)&result.value, sizeof(uint32_t));
+
+		return ms_p -> addEntries(&entry, 1);
+	}
+
+	/**
+	 * @brief Get the last collected result
+	 */
+	const SensorReading_t& getResult() { return result; }
+
+	/**
+	 * @brief Check if the conversion has not been collected yet
+	 */
+	bool isPending() { return pending; }
+};
+
+/**
+ * @brief The members of one sweep
+ *
+ * The members are held by reference, the list itself has no state besides them.
+ *
+ * Example:
+	* \code
+	MAX31865_Bus mySensorBus(&hspi1);
+	SensorChannel<MyADC> adcChannel(myADC, 5);
+
+	SensorList<MAX31865_Bus, SensorChannel<MyADC>> stationSensors(mySensorBus, adcChannel);
+	⋮
+	stationSensors.startConversions();
+	while( !stationSensors.poll() );
+	stationSensors.storeAll(&myMS, deltaT);
+	* \endcode
+ */
+template<typename... Members_p> class SensorList;
+
+template<>
+class SensorList<>{
+public:
+	void startConversions() {}
+	bool poll() { return true; }
+	uint8_t storeAll( MeasurementStorage*, uint16_t ) { return 0; }
+};
+
+template<typename Member_p, typename... Rest_p>
+class SensorList<Member_p, Rest_p...>{
+private:
+	Member_p& member;				///< The first member
+	SensorList<Rest_p...> rest;		///< The rest of the list
+
+public:
+	/**
+	 * @brief Constructor for the SensorList class
+	 *
+	 * @param member_p the first member
+	 * @param rest_p the rest of the members, in the order of the template arguments
+	 */
+	SensorList( Member_p& member_p, Rest_p&... rest_p ) : member(member_p), rest(rest_p...) {}
+
+	/**
+	 * @brief Start the conversions of every member, back to back
+	 */
+	void startConversions()
+	{
+		member.startConversions();
+		rest.startConversions();
+	}
+
+	/**
+	 * @brief Collect the finished conversions of every member, never waits
+	 *
+	 * @returns True when every member has collected all of its conversions
+	 */
+	bool poll()
+	{
+		//Every member is polled, even if an earlier one is not ready yet
+		bool collected = member.poll();
+		return rest.poll() && collected;
+	}
+
+	/**
+	 * @brief Store the collected results of every member
+	 *
+	 * The first stored entry gets the given deltaT, the rest 0, as they were taken in the same sweep.
+	 *
+	 * @returns The number of stored entries
+	 */
+	uint8_t storeAll( MeasurementStorage* ms_p, uint16_t deltaT_p )
+	{
+		uint8_t stored = member.storeAll(ms_p, deltaT_p);
+		return stored + rest.storeAll(ms_p, (stored != 0) ? 0 : deltaT_p);
+	}
+};
+
+#endif /* MODULES_SENSOR_SENSORLIST_HPP_ */
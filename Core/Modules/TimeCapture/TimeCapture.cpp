@@ -0,0 +1,48 @@
+/*
+ * TimeCapture.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "TimeCapture.hpp"
+
+TimeCapture::TimeCapture( TIM_HandleTypeDef* htim_p )
+{
+	htim = htim_p;
+}
+
+void TimeCapture::start()
+{
+	__HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+	HAL_TIM_Base_Start_IT(htim);
+}
+
+void TimeCapture::onOverflow()
+{
+	overflows++;
+}
+
+uint64_t TimeCapture::now()
+{
+	uint32_t high;
+	uint32_t count;
+	bool pending;
+
+	//Read again if the overflow interrupt ran in between
+	do
+	{
+		high = overflows;
+		count = htim->Instance->CNT;
+		pending = __HAL_TIM_GET_FLAG(htim, TIM_FLAG_UPDATE);
+	} while( high != overflows );
+
+	//The counter wrapped, but the interrupt has not run yet (it is masked or has the same priority as the caller).
+	//A count from before the wrap is near the top
+	if( pending && count < 0x80000000 )
+	{
+		high++;
+	}
+
+	return ((uint64_t)high << 32) | count;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file TimeCapture.hpp
+ * @brief Free-running microsecond time of a 32-bit timer, extended to 64 bits.
+ *
+ * @details The timer counts at 1 MHz without a reload, every overflow is counted in its interrupt and gives the upper 32 bits.
+ * An event is captured by reading the time first thing in its interrupt, the difference of two captures is exact to about a us.
+ * The timer runs from the system clock, so it only measures short intervals while the MCU is awake (it stops in STOP mode and
+ * is only as accurate as the HSI), the absolute time is given by the RTC.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_TIMECAPTURE_TIMECAPTURE_HPP_
+#define MODULES_TIMECAPTURE_TIMECAPTURE_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+
+/**
+ * @brief Class of the captured time
+ *
+ * Example:
+	* \code
+	TimeCapture captureClock(&htim5);
+
+	void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+	{
+		if(htim == &htim5) { captureClock.onOverflow(); }
+	}
+
+	void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+	{
+		edgeTime = captureClock.now();
+	}
+	⋮
+	captureClock.start();
+ * \endcode
+ */
+class TimeCapture{
+private:
+	TIM_HandleTypeDef* htim;			///< The timer, a 32-bit one (TIM2 or TIM5) counting at 1 MHz up to 0xFFFFFFFF
+	volatile uint32_t overflows = 0;	///< The upper 32 bits of the time
+
+public:
+	/**
+	 * @brief Constructor of the TimeCapture class
+	 *
+	 * @param htim_p the initialized timer
+	 */
+	TimeCapture( TIM_HandleTypeDef* htim_p );
+
+	/**
+	 * @brief Start the timer and its overflow interrupt
+	 */
+	void start();
+
+	/**
+	 * @brief Count an overflow, called from the update interrupt of the timer
+	 */
+	void onOverflow();
+
+	/**
+	 * @brief Get the time since the start in us
+	 *
+	 * Can be called from an interrupt, also if the overflow interrupt is pending.
+	 */
+	uint64_t now();
+};
+
+#endif /* MODULES_TIMECAPTURE_TIMECAPTURE_HPP_ */
@@ -0,0 +1,126 @@
+/*
+ * TxQueue.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: Sásdi András
+ */
+
+#include "TxQueue.hpp"
+#include <string.h>
+
+TxQueue::TxQueue( UART_HandleTypeDef* huart_p )
+{
+	huart = huart_p;
+}
+
+void TxQueue::startTransfer()
+{
+	uint16_t start = tail;
+	uint16_t end = head;
+
+	if( start == end )
+	{
+		return;
+	}
+
+	//The DMA can only send a contiguous block, the part after the wrap goes in the next transfer
+	uint16_t length = (end > start) ? (end - start) : (TXQUEUE_SIZE - start);
+
+	inFlight = length;
+	if( HAL_UART_Transmit_DMA(huart, &ring[start], length) != HAL_OK )
+	{
+		inFlight = 0;
+	}
+}
+
+bool TxQueue::write( const uint8_t* data_p, uint16_t size_p )
+{
+	if( size_p == 0 )
+	{
+		return true;
+	}
+
+	if( size_p > getFree() )
+	{
+		droppedMessages++;
+		droppedBytes += size_p;
+		return false;
+	}
+
+	uint16_t position = head;
+	uint16_t first = TXQUEUE_SIZE - position;
+	if( first > size_p ) { first = size_p; }
+
+	memcpy(&ring[position], data_p, first);
+	memcpy(&ring[0], data_p + first, size_p - first);
+
+	//The bytes have to be in the ring before the interrupt can see them
+	__DMB();
+	head = (position + size_p) & (TXQUEUE_SIZE - 1);
+
+	//If a transfer is running the interrupt continues with the new bytes, else no interrupt can come until this one starts
+	if( inFlight == 0 )
+	{
+		startTransfer();
+	}
+
+	return true;
+}
+
+bool TxQueue::send( const char* text_p )
+{
+	return write((const uint8_t*)text_p, strlen(text_p));
+}
+
+uint16_t TxQueue::getFree()
+{
+	uint16_t used = (head - tail) & (TXQUEUE_SIZE - 1);
+	return TXQUEUE_SIZE - 1 - used;
+}
+
+bool TxQueue::isIdle()
+{
+	return head == tail && inFlight == 0;
+}
+
+void TxQueue::onTransmitComplete()
+{
+	tail = (tail + inFlight) & (TXQUEUE_SIZE - 1);
+	inFlight = 0;
+	startTransfer();
+}
+
+void TxQueue::onError()
+{
+	//A receive error does not stop the transmission
+	if( inFlight == 0 || huart->gState != HAL_UART_STATE_READY )
+	{
+		return;
+	}
+
+	droppedMessages++;
+	droppedBytes += inFlight;
+	onTransmitComplete();
+}
+
+void TxQueue::onAbort()
+{
+	if( inFlight == 0 )
+	{
+		return;
+	}
+
+	droppedMessages++;
+	droppedBytes += inFlight;
+	onTransmitComplete();
+}
+
+uint32_t TxQueue::getDroppedMessages()
+{
+	return droppedMessages;
+}
+
+uint32_t TxQueue::getDroppedBytes()
+{
+	return droppedBytes;
+}
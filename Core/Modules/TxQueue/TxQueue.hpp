@@ -0,0 +1,116 @@
+/**
+ * @file TxQueue.hpp
+ * @brief Transmit queue of a UART drained by DMA.
+ *
+ * @details The messages are copied into a ring buffer and the function returns at once, the DMA sends the buffer
+ * in the background. When a transfer is complete the next contiguous part of the ring is started from the interrupt.
+ * A message that does not fit is dropped as a whole and counted, the free space can be checked before a long output
+ * (e.g.: the readout) to hold it back instead of losing lines.
+ *
+ * @author Sásdi András
+ * @date October 18, 2026
+ */
+#ifndef MODULES_TXQUEUE_TXQUEUE_HPP_
+#define MODULES_TXQUEUE_TXQUEUE_HPP_
+
+#include "stm32f4xx_hal.h"
+#include <stdint.h>
+
+/// Size of the ring buffer in bytes (must be a power of two)
+#define TXQUEUE_SIZE 1024
+
+/**
+ * @brief Class of the transmit queue
+ *
+ * Written only from the main context, \link TxQueue::onTransmitComplete onTransmitComplete \endlink is called from the interrupt.
+ *
+ * Example:
+	* \code
+	TxQueue txQueue(&huart2);
+
+	void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+	{
+		txQueue.onTransmitComplete();
+	}
+
+	//In the main context
+	txQueue.send("MEAS_STATION\r\n");
+ * \endcode
+ */
+class TxQueue{
+private:
+	UART_HandleTypeDef* huart;			///< The UART, its TX has to be linked to a DMA stream
+	uint8_t ring[TXQUEUE_SIZE];			///< The bytes waiting to be sent
+	volatile uint16_t head = 0;			///< Written by the main context, where the next byte is put
+	volatile uint16_t tail = 0;			///< Written by the interrupt, the first byte not yet sent
+	volatile uint16_t inFlight = 0;		///< Number of bytes the DMA is sending, 0 if it is idle
+
+	uint32_t droppedMessages = 0;		///< Messages lost because the ring was full
+	uint32_t droppedBytes = 0;			///< Bytes of the lost messages
+
+	/**
+	 * @brief Start the DMA on the contiguous part of the ring from the tail
+	 *
+	 * Only called when no transfer is running.
+	 */
+	void startTransfer();
+
+public:
+	/**
+	 * @brief Constructor of the TxQueue class
+	 *
+	 * @param huart_p the UART used for sending
+	 */
+	TxQueue( UART_HandleTypeDef* huart_p );
+
+	/**
+	 * @brief Queue bytes to be sent
+	 *
+	 * @returns False if the bytes did not fit, then nothing is queued
+	 */
+	bool write( const uint8_t* data_p, uint16_t size_p );
+
+	/**
+	 * @brief Queue a '\0' terminated text
+	 *
+	 * @returns False if the text did not fit, then nothing is queued
+	 */
+	bool send( const char* text_p );
+
+	/**
+	 * @brief Get the number of bytes that can be queued now
+	 */
+	uint16_t getFree();
+
+	/**
+	 * @brief Check if every queued byte has been sent
+	 */
+	bool isIdle();
+
+	/**
+	 * @brief Called from HAL_UART_TxCpltCallback, releases the sent bytes and starts the next transfer
+	 */
+	void onTransmitComplete();
+
+	/**
+	 * @brief Called from HAL_UART_ErrorCallback, if the DMA transfer was stopped by an error its bytes are dropped and the next transfer is started
+	 */
+	void onError();
+
+	/**
+	 * @brief Called once the UART is ready again after HAL_UART_Abort, which gives no callback. The bytes of the stopped transfer are dropped and the next transfer is started
+	 */
+	void onAbort();
+
+	/**
+	 * @brief Get the number of messages lost because the ring was full
+	 */
+	uint32_t getDroppedMessages();
+
+	/**
+	 * @brief Get the number of bytes of the lost messages
+	 */
+	uint32_t getDroppedBytes();
+};
+
+#endif /* MODULES_TXQUEUE_TXQUEUE_HPP_ */
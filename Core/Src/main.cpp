@@ -23,6 +23,17 @@
 /* USER CODE BEGIN Includes */
 #include "GPIO.hpp"
 #include "MAX31865.hpp"
+#include "MAX31865_Bus.hpp"
+#include "SensorList.hpp"
+#include "Scheduler.hpp"
+#include "LineQueue.hpp"
+#include "TxQueue.hpp"
+#include "CommandTable.hpp"
+#include "Frame.hpp"
+#include "EntryPacker.hpp"
+#include "AdaptiveRate.hpp"
+#include "RTClock.hpp"
+#include "TimeCapture.hpp"
 #include "MS.hpp"
 #include "stdio.h"
 #include "string.h"
@@ -43,11 +54,82 @@ typedef enum{
 	READOUT,
 } commStates;
 
+typedef enum{
+	LOG_PERIODIC,	//Every sample is stored
+	LOG_DEADBAND,	//Only stored if the temperature left the threshold window or the heartbeat interval elapsed
+	LOG_ADAPTIVE,	//The period follows the rate of change, the average write rate stays at or below the one of measFrequency
+} logModes;
+
+typedef enum{
+	ACQ_KEEP,		//Nothing to do
+	ACQ_CONTINUOUS,	//Leave the low-duty mode, once no duty-cycled measurement is running
+	ACQ_DUTY,		//Enter the low-duty mode
+} acqActions;
+
+typedef enum{
+	CAL_NONE,		//Nothing to do
+	CAL_APPLY,		//Calibrate from the captured points and store it
+	CAL_RESET,		//Remove the calibration
+} calActions;
+
+typedef enum{
+	EVENT_TICK,		//RTC: the wakeup timer reached the sample time
+	EVENT_COMMAND,	//USART2: a command line has been received
+	EVENT_DRDY,		//EXTI: a device finished a conversion
+} events;
+
+typedef enum{
+	LIST_NONE,		//Nothing to list
+	LIST_HELP,		//The commands with their arguments
+	LIST_STATS,		//The statistics of the commands
+} listings;
+
+typedef enum{
+	BAUD_IDLE,		//The rate is in effect
+	BAUD_SWITCH,	//The reply is sent at the old rate, then the new one is set
+	BAUD_CONFIRM,	//Waiting for the host to confirm the new rate, else the old one is restored
+} baudStates;
+
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
 #define Buffer_Size 100
+/// How often a health check (fault detection) is run between the samples [ms]
+#define HEALTHCHECK_INTERVAL 60000
+/// Filter stage used on the continuous conversions between two logged samples
+#define DEFAULT_FILTER FILTER_AVERAGE
+/// Window size or IIR shift of the filter stage, if setFilter does not give one
+#define DEFAULT_FILTER_PARAM 8
+/// Default half width of the threshold window in deadband logging mode [C]
+#define DEFAULT_DEADBAND 0.1
+/// Default maximum time between two stored samples in deadband logging mode [s]
+#define DEFAULT_HEARTBEAT 3600
+/// Default bounds of the period in adaptive logging mode [s]
+#define DEFAULT_ADAPTIVE_MIN 1
+#define DEFAULT_ADAPTIVE_MAX 60
+/// Default wanted change between two samples in adaptive logging mode [C]
+#define DEFAULT_ADAPTIVE_STEP 0.05
+/// Number of entries sent by READOUT on one pass of the main loop, the events are handled in between
+#define READOUT_CHUNK 8
+/// Number of entries in a frame of the binary readout, after the index of the first one
+#define READOUT_FRAME_ENTRIES ((FRAME_MAX_PAYLOAD - sizeof(uint16_t)) / MeasEntry::len)
+/// Most entries read for a packed frame of the binary readout, the ones that do not fit are read again for the next frame
+#define READOUT_PACKED_ENTRIES 48
+/// Time the host has to confirm a new baud rate before the old one is restored [ms]
+#define BAUD_CONFIRM_TIMEOUT 1000
+/// Baud rate of USART2 after reset, the one a new host starts talking on
+#define DEFAULT_BAUD 115200
+/// Time without a received line after which a switched baud rate goes back to DEFAULT_BAUD, the host may be gone [s]
+#define BAUD_IDLE_TIMEOUT 60
+/// Size of the circular DMA buffer of the reception, half of it must arrive faster than the main loop takes it out
+#define RX_DMA_SIZE 64
+/// Shortest sample period [ms], a sweep and its storing have to fit into it
+#define MIN_SAMPLE_PERIOD 100
+/// Time unit of deltaT [ms] chosen at INIT for a period shorter than a second, if the host does not give one
+#define DEFAULT_FAST_TIME_UNIT 10
+/// Time after a received byte when STOP mode is not entered, so the rest of the conversation is not lost [s]
+#define STOP_HOLDOFF 5
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -60,49 +142,110 @@ I2C_HandleTypeDef hi2c1;
 
 SPI_HandleTypeDef hspi1;
 
-TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim5;
 
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE BEGIN PV */
-uint32_t measFrequency = 3; //[s]
-uint32_t idleTime = 0;
-MeasEntry currentMeas;
-
-char commandBuffer[Buffer_Size];
-char argBuffer[Buffer_Size];
-
-
-uint32_t timerInterruptCntr = 0;
-bool timeInterruptTick = false;
+uint32_t measFrequency = 3000; //[ms]
+uint32_t samplePeriod = 3000; //[ms], the period in effect: measFrequency, or the one chosen in adaptive mode
+uint32_t wakeupPeriod = 0; //[ms], the period the RTC wakeup timer runs with, 0: stopped
+bool tickPending = false; //A tick arrived, the sample is taken as soon as the devices are free
+
+//The time of the entries is read from the RTC, it runs on in COMM state and in STOP mode
+RTClock myClock;
+uint64_t lastStoreTime = 0; //[ms], unix time of the last stored sweep, as the host reconstructs it from the deltaTs
+uint64_t sampleTime = 0; //[ms], unix time of the conversion of the last sweep
+uint16_t timeUnit = MS_TIME_UNIT_DEFAULT; //[ms], the unit of deltaT in the session of the storage
+
+//The instant of a sample is the DRDY edge of its conversion, captured on the free-running TIM5
+TimeCapture captureClock(&htim5);
+volatile uint64_t drdyCapture = 0; //[us], TIM5 time of the last DRDY edge
+volatile bool drdyCaptured = false; //A DRDY edge arrived since the running sweep started
+volatile uint32_t lastRxActivity = 0; //[s], unix time of the last received byte that woke up the MCU or the last command
 
 bool displayMeas = true;
 
+bool healthCheckPlanned = false;
+
+Scheduler myScheduler;
+bool onEntry_meas = true;
+bool onEntry_comm = true;
+uint16_t readoutPosition = 0; //The next entry sent by READOUT
+
+//Baud rates the host can switch to, USART2 runs from 42 MHz with 16x oversampling, so these are within 0.5 %
+//(921600 is left out, it would be 1.3 % off)
+const uint32_t baudRates[] = {115200, 230400, 460800, 1000000, 2000000};
+baudStates baudState = BAUD_IDLE;
+uint32_t newBaudRate = 0;
+uint32_t previousBaudRate = 0;
+uint32_t baudSwitchTime = 0; //[ms]
+
+//The binary readout is streamed besides the measurement, in any state
+bool streamActive = false;
+uint16_t streamPosition = 0; //The next entry sent
+uint16_t streamEnd = 0; //The stream stops before this entry
+uint16_t streamSequence = 0; //Sequence number of the next frame, 0: the header is next
+bool streamPacked = false; //The entries are compressed
+EntryPacker entryPacker;
+
+logModes loggingMode = LOG_PERIODIC;
+logModes appliedLoggingMode = LOG_PERIODIC; //The mode the devices and the DRDY interrupt are set up for
+bool logModeChanged = false;
+SampleFilterType_t filterType = DEFAULT_FILTER; //Set by setFilter, deadband mode turns the filter off and restores it when it ends
+uint8_t filterParam = DEFAULT_FILTER_PARAM;
+float deadband = DEFAULT_DEADBAND; //[C]
+uint32_t heartbeat = DEFAULT_HEARTBEAT; //[s]
+uint32_t sinceLastStore = 0; //[ms], from the last stored sweep to the running one
+
+AdaptiveRate adaptiveRate;
+
+bool sweepRunning = false;
+uint32_t sweepStart = 0;
+
+//Set by the command, done in the main loop as it needs the SPI bus
+volatile acqActions acquisitionAction = ACQ_KEEP;
+uint8_t dutyTimeConstants = BIAS_SETTLE_TIME_CONSTANTS;
+
+//Set by the command, done in the main loop as it needs the EEPROM
+volatile calActions calibrationAction = CAL_NONE;
+uint8_t calibrationID = 0;
+
 states currentState = MEAS;
-const char* MEAS_command = "enterMeas";
-const char* COMM_command = "enterComm";
-const char* GETSTATE_command = "getState";
-const char* WHOAMI_command = "whoami";
-const char* FREQ_command = "setFrequency";
-const char* DISPLAYMEAS_command = "displayMeas";
+const char* LOGMODE_arg_periodic = "PERIODIC";
+const char* LOGMODE_arg_deadband = "DEADBAND";
+const char* LOGMODE_arg_adaptive = "ADAPTIVE";
+const char* ALARM_arg_off = "OFF";
+const char* ACQ_arg_continuous = "CONTINUOUS";
+const char* ACQ_arg_duty = "DUTY";
+const char* CAL_arg_apply = "APPLY";
+const char* CAL_arg_reset = "RESET";
+const char* READBIN_arg_packed = "PACKED";
+const char* FILTER_arg_none = "NONE";
+const char* FILTER_arg_average = "AVG";
+const char* FILTER_arg_movingAverage = "MA";
+const char* FILTER_arg_median = "MEDIAN";
+const char* FILTER_arg_iir = "IIR";
 const char* DISPLAYMEAS_arg_true = "ON";
 const char* DISPLAYMEAS_arg_false = "OFF";
 
 commStates currentCommState = IDLE;
-const char* CommIDLE_command = "IDLE";
-const char* CommINIT_command = "INIT";
-const char* CommREADOUT_command = "READOUT";
 
 uint64_t initTimeastamp = 0;
 
+listings currentListing = LIST_NONE;
+uint8_t listingPosition = 0; //The next command listed
+
 bool measCommand = false;
-bool sendComplete = true;
 
 char msg[Buffer_Size];
-uint8_t RxData[Buffer_Size];
-uint8_t tmp[2];
-uint8_t FinalData[Buffer_Size];
-uint8_t idx = 0;
+uint8_t rxDmaBuffer[RX_DMA_SIZE]; //Written by the DMA in a circle
+uint16_t rxDmaPosition = 0; //The next byte of rxDmaBuffer not yet put into the commandQueue
+uint8_t FinalData[Buffer_Size]; //The command line being parsed
+LineQueue commandQueue;
+TxQueue txQueue(&huart2); //Every reply and displayed line, sent by DMA in the background
 
 
 
@@ -110,16 +253,22 @@ GPIO TEMP_SENS_CS(TEMP_SENS_CS_GPIO_Port, TEMP_SENS_CS_Pin);
 GPIO TEMP_RDY(TEMP_RDY_GPIO_Port, TEMP_RDY_Pin);
 
 MAX31865 myPT100(&hspi1, &TEMP_SENS_CS, &TEMP_RDY);
+MAX31865_Bus mySensorBus(&hspi1);
+
+//Everything sampled in one sweep, further sensor types are added as SensorChannel<Driver> members
+typedef SensorList<MAX31865_Bus> StationSensors_t;
+StationSensors_t stationSensors(mySensorBus);
 MeasurementStorage myMS(&hi2c1, 80);
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 static void MX_I2C1_Init(void);
 static void MX_SPI1_Init(void);
-static void MX_TIM3_Init(void);
+static void MX_TIM5_Init(void);
 /* USER CODE BEGIN PFP */
 void i2cScann(I2C_HandleTypeDef *hi2c_p, uint8_t* devicesBuffer_p)
 {
@@ -139,119 +288,1008 @@ void i2cScann(I2C_HandleTypeDef *hi2c_p, uint8_t* devicesBuffer_p)
 	}
 }
 
-void handleMessage()
+void cmdEnterMeas(CommandArgs& args_p)
+{
+	currentState = MEAS;
+}
+
+void cmdEnterComm(CommandArgs& args_p)
+{
+	currentState = COMM;
+}
+
+void cmdGetState(CommandArgs& args_p)
+{
+	txQueue.send(currentState == MEAS ? "MEAS\r\n" : "COMM\r\n");
+}
+
+void cmdWhoami(CommandArgs& args_p)
+{
+	txQueue.send("MEAS_STATION\r\n");
+}
+
+void cmdDisplayMeas(CommandArgs& args_p)
+{
+	if(args_p.is(0, DISPLAYMEAS_arg_true))
+	{
+		displayMeas = true;
+	}
+	else if(args_p.is(0, DISPLAYMEAS_arg_false))
+	{
+		displayMeas = false;
+	}
+}
+
+void cmdGetHealthCost(CommandArgs& args_p)
+{
+	//Time spent on health checks instead of measuring [ms/h]
+	snprintf(msg, Buffer_Size, "%lu\r\n", mySensorBus.getFaultDetectCostPerHour());
+	txQueue.send(msg);
+}
+
+void cmdGetLatency(CommandArgs& args_p)
 {
+	//Largest time from the interrupt to its handler [us] since the last query, and the events lost on a full queue
+	snprintf(msg, Buffer_Size, "%lu; %lu; %lu; %lu\r\n", myScheduler.getMaxLatencyUs(EVENT_TICK), myScheduler.getMaxLatencyUs(EVENT_COMMAND),
+			myScheduler.getMaxLatencyUs(EVENT_DRDY), myScheduler.getDropped());
+	txQueue.send(msg);
+	myScheduler.resetStats();
+}
 
-	uint8_t matchResult = sscanf((const char*)FinalData, "%s %s", commandBuffer, argBuffer);
+void cmdGetTxDropped(CommandArgs& args_p)
+{
+	//Messages and bytes lost on a full transmit queue since the start
+	snprintf(msg, Buffer_Size, "%lu; %lu\r\n", txQueue.getDroppedMessages(), txQueue.getDroppedBytes());
+	txQueue.send(msg);
+}
 
-	if(matchResult > 0)
+void cmdGetClock(CommandArgs& args_p)
+{
+	//Unix time of the RTC [ms] and its clock, the host can check the drift
+	snprintf(msg, Buffer_Size, "%llu; %s\r\n", myClock.getTimeMs(), (myClock.getSource() == RTCLOCK_LSE) ? "LSE" : "LSI");
+	txQueue.send(msg);
+}
+
+void limitHeartbeat()
+{
+	//The gap has to fit into deltaT in the unit of the session
+	uint32_t longestGap = (uint32_t)UINT16_MAX * timeUnit / 1000; //[s]
+	longestGap = (longestGap > measFrequency / 1000) ? longestGap - measFrequency / 1000 : 1;
+	if(heartbeat > longestGap) { heartbeat = longestGap; }
+}
+
+void cmdSetLogMode(CommandArgs& args_p)
+{
+	if(args_p.is(0, LOGMODE_arg_periodic))
+	{
+		loggingMode = LOG_PERIODIC;
+		logModeChanged = true;
+	}
+	else if(args_p.is(0, LOGMODE_arg_deadband))
 	{
-		if( strcmp((const char*) commandBuffer, MEAS_command) == 0)
+		//Deadband [C], optional: heartbeat [s]. A window of zero width would trip on every conversion
+		float newDeadband = 0;
+		if(!args_p.getFloat(1, &newDeadband) || !(newDeadband > 0))
 		{
-			currentState = MEAS;
+			txQueue.send("LOGMODE FAIL\r\n");
+			return;
 		}
-		else if( strcmp((const char*) commandBuffer, COMM_command) == 0)
+		deadband = newDeadband;
+		args_p.getUInt(2, &heartbeat);
+		limitHeartbeat();
+		loggingMode = LOG_DEADBAND;
+		logModeChanged = true;
+	}
+	else if(args_p.is(0, LOGMODE_arg_adaptive))
+	{
+		//Optional: shortest period [s], longest period [s] and wanted step [C]
+		uint32_t minPeriod = DEFAULT_ADAPTIVE_MIN;
+		uint32_t maxPeriod = DEFAULT_ADAPTIVE_MAX;
+		float step = DEFAULT_ADAPTIVE_STEP;
+		args_p.getUInt(1, &minPeriod);
+		args_p.getUInt(2, &maxPeriod);
+		args_p.getFloat(3, &step);
+		adaptiveRate.configure(minPeriod, maxPeriod, step, (measFrequency + 999) / 1000);
+		loggingMode = LOG_ADAPTIVE;
+		logModeChanged = true;
+	}
+}
+
+void cmdSetAcquisition(CommandArgs& args_p)
+{
+	if(args_p.is(0, ACQ_arg_continuous) && mySensorBus.isDutyCycled())
+	{
+		acquisitionAction = ACQ_CONTINUOUS;
+	}
+	else if(args_p.is(0, ACQ_arg_duty))
+	{
+		//Optional: number of input filter time constants VBIAS is on before the conversion
+		uint32_t timeConstants = BIAS_SETTLE_TIME_CONSTANTS;
+		args_p.getUInt(1, &timeConstants);
+		dutyTimeConstants = (timeConstants > UINT8_MAX) ? UINT8_MAX : timeConstants;
+		acquisitionAction = ACQ_DUTY;
+	}
+}
+
+void cmdSetAlarm(CommandArgs& args_p)
+{
+	if(args_p.is(0, ALARM_arg_off))
+	{
+		mySensorBus.disableAlarmCapture();
+		return;
+	}
+
+	//Limits [C], optional: number of samples before and after the trigger
+	float alarmLow, alarmHigh;
+	uint32_t alarmPre = ALARMCAPTURE_DEFAULT_PRE;
+	uint32_t alarmPost = ALARMCAPTURE_DEFAULT_POST;
+	if(args_p.getFloat(0, &alarmLow) && args_p.getFloat(1, &alarmHigh))
+	{
+		args_p.getUInt(2, &alarmPre);
+		args_p.getUInt(3, &alarmPost);
+		mySensorBus.setAlarmCapture(alarmLow, alarmHigh, alarmPre, alarmPost);
+	}
+}
+
+void cmdCalibrate(CommandArgs& args_p)
+{
+	//calibrate <measID> <1|2> <true temperature [C]> captures a point from the last sweep, APPLY calibrates and stores, RESET removes it
+	uint32_t measID, point;
+	float reference;
+
+	if(!args_p.getUInt(0, &measID))
+	{
+		return;
+	}
+
+	if(args_p.is(1, CAL_arg_apply))
+	{
+		calibrationID = measID;
+		calibrationAction = CAL_APPLY;
+	}
+	else if(args_p.is(1, CAL_arg_reset))
+	{
+		calibrationID = measID;
+		calibrationAction = CAL_RESET;
+	}
+	else if(args_p.getUInt(1, &point) && args_p.getFloat(2, &reference))
+	{
+		bool captured = mySensorBus.captureCalibrationPoint(measID, point, reference);
+		txQueue.send(captured ? "CAL POINT OK\r\n" : "CAL POINT FAIL\r\n");
+	}
+}
+
+void cmdSetFilter(CommandArgs& args_p)
+{
+	//Optional second word: window size or IIR shift
+	uint32_t param = DEFAULT_FILTER_PARAM;
+	args_p.getUInt(1, &param);
+
+	if(args_p.is(0, FILTER_arg_none)) 					{ filterType = FILTER_NONE; }
+	else if(args_p.is(0, FILTER_arg_average)) 			{ filterType = FILTER_AVERAGE; }
+	else if(args_p.is(0, FILTER_arg_movingAverage)) 	{ filterType = FILTER_MOVING_AVERAGE; }
+	else if(args_p.is(0, FILTER_arg_median)) 			{ filterType = FILTER_MEDIAN; }
+	else if(args_p.is(0, FILTER_arg_iir)) 				{ filterType = FILTER_IIR; }
+	else { return; }
+	filterParam = (param > UINT8_MAX) ? UINT8_MAX : param;
+
+	//In deadband mode it is only remembered, the conversions are not fed in
+	if(loggingMode != LOG_DEADBAND)
+	{
+		mySensorBus.setFilter(filterType, filterParam);
+	}
+}
+
+void cmdSetFrequency(CommandArgs& args_p)
+{
+	//Fractional seconds give the sub-second periods
+	float period = 0;
+	if(args_p.getFloat(0, &period) && period > 0)
+	{
+		if(period > RTCLOCK_MAX_WAKEUP) { period = RTCLOCK_MAX_WAKEUP; }
+		measFrequency = (uint32_t)(period * 1000 + 0.5f);
+	}
+	if(measFrequency < MIN_SAMPLE_PERIOD) { measFrequency = MIN_SAMPLE_PERIOD; }
+	if(loggingMode == LOG_ADAPTIVE)
+	{
+		//The write budget follows the new period, the adaptive periods are whole seconds
+		adaptiveRate.setBudgetPeriod((measFrequency + 999) / 1000);
+	}
+	else
+	{
+		samplePeriod = measFrequency;
+	}
+	healthCheckPlanned = false; //has to be planned again for the new period
+}
+
+//The commands of the COMM state are only accepted in COMM state, except that IDLE also stops a binary readout
+void cmdIdle(CommandArgs& args_p)
+{
+	if(currentState == COMM) { currentCommState = IDLE; }
+	streamActive = false;
+}
+
+void cmdReadout(CommandArgs& args_p)
+{
+	if(currentState == COMM) { currentCommState = READOUT; }
+}
+
+void cmdReadoutBinary(CommandArgs& args_p)
+{
+	//Optional: the first entry and the most entries sent, so the host can continue from the last entry it has
+	uint32_t start = 0;
+	uint32_t maxEntries = UINT16_MAX;
+	args_p.getUInt(0, &start);
+	args_p.getUInt(1, &maxEntries);
+
+	//Also accepted in MEAS state, the measurement goes on while the frames are sent
+	if(start <= UINT16_MAX)
+	{
+		streamPosition = start;
+		streamEnd = (maxEntries > UINT16_MAX - start) ? UINT16_MAX : start + maxEntries;
+		streamSequence = 0;
+		streamPacked = args_p.is(2, READBIN_arg_packed);
+		streamActive = true;
+	}
+}
+
+void cmdInit(CommandArgs& args_p)
+{
+	//The host may send a fractional timestamp, only the whole seconds are used
+	if(currentState == COMM && sscanf(args_p.get(0), "%llu", &initTimeastamp) == 1)
+	{
+		//Optional: the unit of deltaT [ms], by default seconds, or DEFAULT_FAST_TIME_UNIT for a sub-second period
+		uint32_t unit = (measFrequency < 1000) ? DEFAULT_FAST_TIME_UNIT : MS_TIME_UNIT_DEFAULT;
+		args_p.getUInt(1, &unit);
+		if(unit == 0 || unit > 60000) { unit = MS_TIME_UNIT_DEFAULT; }
+		timeUnit = unit;
+		limitHeartbeat();
+
+		currentCommState = INIT;
+		streamActive = false;
+	}
+}
+
+void cmdHelp(CommandArgs& args_p)
+{
+	currentListing = LIST_HELP;
+	listingPosition = 0;
+}
+
+void cmdStats(CommandArgs& args_p)
+{
+	currentListing = LIST_STATS;
+	listingPosition = 0;
+}
+
+void cmdSetBaud(CommandArgs& args_p)
+{
+	uint32_t rate = 0;
+	bool supported = false;
+	args_p.getUInt(0, &rate);
+	for(uint8_t i = 0; i < sizeof(baudRates) / sizeof(baudRates[0]); i++)
+	{
+		if(baudRates[i] == rate) { supported = true; }
+	}
+
+	if(!supported || baudState != BAUD_IDLE)
+	{
+		txQueue.send("BAUD FAIL\r\n");
+		return;
+	}
+
+	//Answered at the current rate, the switch waits until the reply is out
+	snprintf(msg, Buffer_Size, "BAUD %lu\r\n", rate);
+	txQueue.send(msg);
+	newBaudRate = rate;
+	baudState = BAUD_SWITCH;
+}
+
+void cmdConfirmBaud(CommandArgs& args_p)
+{
+	//Received at the new rate, so the link works
+	if(baudState == BAUD_CONFIRM)
+	{
+		baudState = BAUD_IDLE;
+		txQueue.send("BAUD CONFIRMED\r\n");
+	}
+}
+
+//One line per command: name, handler, minimal number of arguments, help text
+constexpr Command_t commandList[] = {
+	command("enterMeas",		cmdEnterMeas,		0, "start measuring"),
+	command("enterComm",		cmdEnterComm,		0, "stop measuring, accept IDLE, INIT and READOUT"),
+	command("getState",			cmdGetState,		0, "MEAS or COMM"),
+	command("whoami",			cmdWhoami,			0, "name of the device"),
+	command("displayMeas",		cmdDisplayMeas,		1, "<ON|OFF> print every sample"),
+	command("getHealthCost",	cmdGetHealthCost,	0, "time spent on health checks [ms/h]"),
+	command("getLatency",		cmdGetLatency,		0, "largest event latencies [us] and lost events"),
+	command("getTxDropped",		cmdGetTxDropped,	0, "messages and bytes lost on a full transmit queue"),
+	command("getClock",			cmdGetClock,		0, "RTC time [unix ms] and its clock (LSE or LSI)"),
+	command("setLogMode",		cmdSetLogMode,		1, "<PERIODIC|DEADBAND <C> [s]|ADAPTIVE [min s] [max s] [step C]>"),
+	command("setAcquisition",	cmdSetAcquisition,	1, "<CONTINUOUS|DUTY [time constants]>"),
+	command("setAlarm",			cmdSetAlarm,		1, "<OFF|low C> <high C> [pre] [post]"),
+	command("calibrate",		cmdCalibrate,		2, "<measID> <1|2 true C|APPLY|RESET>"),
+	command("setFilter",		cmdSetFilter,		1, "<NONE|AVG|MA|MEDIAN|IIR> [window or shift]"),
+	command("setFrequency",		cmdSetFrequency,	1, "<period [s], from 0.1>"),
+	command("IDLE",				cmdIdle,			0, "stop the COMM task"),
+	command("INIT",				cmdInit,			1, "<unix time [s]> [deltaT unit ms] clear the storage"),
+	command("READOUT",			cmdReadout,			0, "send the stored entries"),
+	command("READBIN",			cmdReadoutBinary,	0, "[first] [max entries] [PACKED] send the stored entries in COBS frames with CRC-16"),
+	command("help",				cmdHelp,			0, "list the commands"),
+	command("stats",			cmdStats,			0, "name; handled; rejected; longest run [us] per command"),
+	command("setBaud",			cmdSetBaud,			1, "<rate> switch the baud rate, confirmBaud at the new rate keeps it"),
+	command("confirmBaud",		cmdConfirmBaud,		0, "keep the new baud rate"),
+};
+CommandTable<sizeof(commandList) / sizeof(Command_t)> commandTable(commandList);
+
+void handleMessage()
+{
+	commandTable.dispatch((char*)FinalData);
+}
+
+void listingTask()
+{
+	//Continued on the next passes while the transmit queue has no room, the lists are longer than the queue
+	while(currentListing != LIST_NONE && txQueue.getFree() >= Buffer_Size)
+	{
+		if(listingPosition >= commandTable.size())
 		{
-			currentState = COMM;
+			if(currentListing == LIST_STATS)
+			{
+				snprintf(msg, Buffer_Size, "unknown; %lu\r\nEND\r\n", commandTable.getUnknown());
+				txQueue.send(msg);
+			}
+			else
+			{
+				txQueue.send("END\r\n");
+			}
+			currentListing = LIST_NONE;
+			break;
 		}
 
-		else if( strcmp((const char*) commandBuffer, GETSTATE_command) == 0)
+		const Command_t& listed = commandTable.getCommand(listingPosition);
+		if(currentListing == LIST_HELP)
 		{
-			switch (currentState)
+			snprintf(msg, Buffer_Size, "%s %s\r\n", listed.name, listed.help);
+		}
+		else
+		{
+			const Command_Stats_t& stats = commandTable.getStats(listingPosition);
+			snprintf(msg, Buffer_Size, "%s; %lu; %lu; %lu\r\n", listed.name, stats.count, stats.rejected, stats.maxCycles / (SystemCoreClock / 1000000));
+		}
+		txQueue.send(msg);
+		listingPosition++;
+	}
+}
+
+void healthCheckDone( MAX31865* caller, uint16_t ErrorCode_p )
+{
+	//In deadband mode the threshold faults only tell that the window was left, the driver keeps them for the next tick
+	if(appliedLoggingMode == LOG_DEADBAND) { ErrorCode_p &= ~(HighThrehsold | LowThrehsold); }
+
+	if(displayMeas && !streamActive && ErrorCode_p != 0)
+	{
+		snprintf(msg, Buffer_Size, "HEALTH FAULT 0x%04X\r\n", ErrorCode_p);
+		txQueue.send(msg);
+	}
+}
+
+void updateAdaptivePeriod(uint32_t elapsed_p)
+{
+	float temperatures[MAX31865_BUS_MAX_SENSORS];
+	uint8_t count = mySensorBus.getSensorCount();
+
+	for(uint8_t i = 0; i < count; i++)
+	{
+		temperatures[i] = mySensorBus.getChannel(i)->result.temperature;
+	}
+
+	samplePeriod = adaptiveRate.update(temperatures, count, elapsed_p / 1000) * 1000;
+}
+
+uint32_t timeSinceLastStore(uint64_t now_p)
+{
+	uint64_t elapsed = (now_p > lastStoreTime) ? now_p - lastStoreTime : 0;
+	return (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+}
+
+uint16_t toDeltaT(uint32_t elapsed_p)
+{
+	//Rounded to the unit of the session. Has to fit into deltaT, a longer gap (e.g.: a long stay in COMM state) is cut
+	uint32_t units = (elapsed_p + timeUnit / 2) / timeUnit;
+	return (units > UINT16_MAX) ? UINT16_MAX : (uint16_t)units;
+}
+
+void startSweep()
+{
+	//Only an edge from now on belongs to the conversion of this sweep. If nobody read the conversions meanwhile,
+	//DRDY stayed low since an edge about one conversion after the last sweep, which would date the sample a period early
+	drdyCaptured = false;
+
+	//Every channel is sampled in one sweep, each with a single SPI transaction giving the sample and its health status
+	stationSensors.startConversions();
+	sweepStart = HAL_GetTick();
+	sweepRunning = true;
+}
+
+void finishSweep()
+{
+	sweepRunning = false;
+
+	//The conversion was taken at its DRDY edge: the RTC time now, less the time since the edge.
+	//Without an edge since the sweep started (the DRDY interrupt is off in deadband mode, or DRDY was already low) it is the time of the read
+	__disable_irq();
+	uint64_t sinceConversion = drdyCaptured ? captureClock.now() - drdyCapture : 0; //[us]
+	drdyCaptured = false;
+	__enable_irq();
+	sampleTime = myClock.getTimeMs() - sinceConversion / 1000;
+	sinceLastStore = timeSinceLastStore(sampleTime);
+
+	//Not mixed into the frames of a binary readout
+	if(displayMeas && !streamActive)
+	{
+		for(uint8_t i = 0; i < mySensorBus.getSensorCount(); i++)
+		{
+			const MAX31865_BusChannel_t* channel = mySensorBus.getChannel(i);
+			uint16_t errors = channel->result.errors;
+
+			//In deadband mode leaving the threshold window is not a fault
+			if(loggingMode == LOG_DEADBAND) { errors &= ~(HighThrehsold | LowThrehsold); }
+
+			if(channel->pending)
 			{
-				case MEAS:
-					snprintf(msg, Buffer_Size, "MEAS\r\n");
-					break;
-				case COMM:
-					snprintf(msg, Buffer_Size, "COMM\r\n");
-					break;
-				default:
-					break;
+				snprintf(msg, Buffer_Size, "%u: TIMEOUT\r\n", channel->measID);
+			}
+			else if(errors == 0)
+			{
+				snprintf(msg, Buffer_Size, "%u: %0.3f \r\n", channel->measID, channel->result.temperature);
 			}
-			HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
+			else
+			{
+				snprintf(msg, Buffer_Size, "%u: %0.3f FAULT 0x%04X\r\n", channel->measID, channel->result.temperature, errors);
+			}
+			txQueue.send(msg);
 		}
-		else if( strcmp((const char*) commandBuffer, WHOAMI_command) == 0)
+	}
+
+	if(loggingMode == LOG_DEADBAND && sinceLastStore < heartbeat * 1000)
+	{
+		//In low-duty mode every tick is a sweep, only the ones outside the window are stored
+		bool tripped = false;
+		for(uint8_t i = 0; i < mySensorBus.getSensorCount(); i++)
 		{
-			snprintf(msg, Buffer_Size, "MEAS_STATION\r\n");
+			if((mySensorBus.getChannel(i)->result.errors & (HighThrehsold | LowThrehsold)) != 0) { tripped = true; }
+		}
+		if(!tripped) { return; }
+	}
+
+	uint16_t deltaT = toDeltaT(sinceLastStore);
+	stationSensors.storeAll(&myMS, deltaT);
+
+	//Advanced as the host adds up the deltaTs, so the rounding to the unit does not add up over a long log
+	lastStoreTime = (deltaT == UINT16_MAX) ? sampleTime : lastStoreTime + (uint64_t)deltaT * timeUnit;
+
+	if(loggingMode == LOG_DEADBAND)
+	{
+		mySensorBus.setDeadbandWindows(deadband);
+	}
+
+	if(loggingMode == LOG_ADAPTIVE)
+	{
+		updateAdaptivePeriod(sinceLastStore);
+	}
+	sinceLastStore = 0;
+
+	//Starts the health check if it is due, it finishes before the next sample
+	mySensorBus.sampleTaken();
+}
+
+void onTick(uint32_t)
+{
+	//The elapsed time is read from the RTC when the sample is taken, so a deferred tick is not lost
+	tickPending = true;
+}
+
+void onCommand(uint32_t)
+{
+	lastRxActivity = (uint32_t)myClock.getTime();
 
-			HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
+	//Every completed line, also the ones whose event was dropped on a full event queue
+	while(commandQueue.getLine((char*)FinalData, Buffer_Size))
+	{
+		handleMessage();
+	}
+}
+
+void onDrdy(uint32_t)
+{
+	//Feed every conversion into the filters and the alarm captures. The events run before the poll hook,
+	//so during a sweep the conversion is left for its collection, which feeds it in as well
+	if(currentState == MEAS && !sweepRunning)
+	{
+		mySensorBus.acquire();
+	}
+}
+
+void measTask()
+{
+	if(onEntry_meas)
+	{
+		onEntry_meas = false;
+		onEntry_comm = true;
+		currentCommState = IDLE; //The next time COMM state is entered it will be idle
+	}
+
+	if(!healthCheckPlanned)//Fit the health checks between the samples
+	{
+		//In adaptive mode the detection has to fit into the shortest period
+		uint32_t planPeriod = (loggingMode == LOG_ADAPTIVE) ? adaptiveRate.getMinPeriod() * 1000 : measFrequency;
+		mySensorBus.planFaultDetection(planPeriod, HEALTHCHECK_INTERVAL, healthCheckDone);
+		healthCheckPlanned = true;
+	}
+
+	if(logModeChanged)
+	{
+		if(loggingMode == LOG_DEADBAND)
+		{
+			//Only the fault status is checked on the ticks, the MCU is not woken up by every conversion
+			mySensorBus.setFilter(FILTER_NONE, 1);
+			HAL_NVIC_DisableIRQ(EXTI9_5_IRQn);
+			mySensorBus.setDeadbandWindows(deadband);
 		}
-		else if( strcmp((const char*) commandBuffer, DISPLAYMEAS_command) == 0)
+		else
 		{
-			if(strcmp((const char*) argBuffer, DISPLAYMEAS_arg_true) == 0)
+			if(appliedLoggingMode == LOG_DEADBAND)
 			{
-				displayMeas = true;
+				//The last window would go on flagging the conversions with a threshold fault
+				mySensorBus.clearDeadbandWindows();
 			}
-			else if(strcmp((const char*) argBuffer, DISPLAYMEAS_arg_false) == 0)
+			mySensorBus.setFilter(filterType, filterParam);
+			HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+		}
+		appliedLoggingMode = loggingMode;
+		samplePeriod = (loggingMode == LOG_ADAPTIVE) ? adaptiveRate.getPeriod() * 1000 : measFrequency;
+		healthCheckPlanned = false;
+		logModeChanged = false;
+	}
+
+	//Not during a sweep, its duty-cycled measurements are collected by the sweep
+	if(acquisitionAction != ACQ_KEEP && !sweepRunning)
+	{
+		if(acquisitionAction == ACQ_DUTY)
+		{
+			mySensorBus.startDutyCycledMeas(dutyTimeConstants);
+			acquisitionAction = ACQ_KEEP;
+			healthCheckPlanned = false;
+		}
+		else if(mySensorBus.stopDutyCycledMeas())//Tried again on the next pass while a measurement is still running
+		{
+			acquisitionAction = ACQ_KEEP;
+			healthCheckPlanned = false;
+		}
+	}
+
+	if(wakeupPeriod != samplePeriod)//Started on entry and restarted when the period changed, the next tick comes one period from now
+	{
+		wakeupPeriod = myClock.startWakeup(samplePeriod) ? samplePeriod : 0;
+	}
+
+	//While a health check runs the devices are not converting, the sample is taken once it has finished
+	if(tickPending && !mySensorBus.isFaultDetectionBusy() && !sweepRunning)//Storing the Data
+	{
+		//Only for the decision, the stored time is taken from the conversion when the sweep finishes
+		sinceLastStore = timeSinceLastStore(myClock.getTimeMs());
+
+		//In deadband mode the devices compare every conversion with the window, a short fault status read tells if a new value is needed.
+		//In low-duty mode the devices are not converting between the ticks, so the sweep itself tells it
+		if(loggingMode != LOG_DEADBAND || sinceLastStore >= heartbeat * 1000 || mySensorBus.isDutyCycled() || mySensorBus.deadbandTripped())
+		{
+			startSweep();
+		}
+
+		tickPending = false;
+	}
+
+	//Collected before the filters are fed, so the sweep gets its own conversion
+	if(sweepRunning && ( stationSensors.poll() || (HAL_GetTick() - sweepStart) > MAX31865_BUS_TIMEOUT ))
+	{
+		finishSweep();
+	}
+
+	if(mySensorBus.isAlarmPending())//The burst around the alarm is stored besides the periodic log
+	{
+		mySensorBus.storeAlarms(&myMS, toDeltaT(timeSinceLastStore(myClock.getTimeMs())));
+	}
+
+	mySensorBus.faultDetectionTick();
+}
+
+void sendReadoutFrame()
+{
+	uint8_t payload[FRAME_MAX_PAYLOAD];
+	uint8_t frame[FRAME_MAX_ENCODED + 1];
+	uint16_t length;
+
+	if(streamSequence == 0)
+	{
+		//The entries stored from now on are not part of this readout, so the host gets a consistent snapshot.
+		//The entries are only appended, the ones below the snapshot do not change meanwhile
+		uint64_t timestamp = myMS.readTimestamp();
+		uint16_t count = myMS.readCounter();
+		uint16_t unit = myMS.readTimeUnit();
+		if(streamEnd > count) { streamEnd = count; }
+
+		//The timestamp identifies the measurement, the host's entries are only continued if it has not changed
+		uint8_t* field = payload;
+		memcpy(field, &timestamp, sizeof(timestamp));				field += sizeof(timestamp);
+		memcpy(field, &count, sizeof(count));						field += sizeof(count);
+		*field = MeasEntry::len;									field += 1;
+		memcpy(field, &streamPosition, sizeof(streamPosition));		field += sizeof(streamPosition);
+		memcpy(field, &unit, sizeof(unit));							field += sizeof(unit);
+
+		//A leading zero closes the text sent before, so the host finds the start of the header
+		frame[0] = 0;
+		length = buildFrame(FRAME_HEADER, streamSequence, payload, field - payload, frame + 1) + 1;
+	}
+	else
+	{
+		uint16_t wanted = (streamEnd > streamPosition) ? streamEnd - streamPosition : 0;
+		uint16_t limit = streamPacked ? READOUT_PACKED_ENTRIES : READOUT_FRAME_ENTRIES;
+		if(wanted > limit) { wanted = limit; }
+
+		uint8_t entries[READOUT_PACKED_ENTRIES * MeasEntry::len];
+		uint16_t read = (wanted == 0) ? 0 : myMS.readEntries(streamPosition, wanted, entries);
+		memcpy(payload, &streamPosition, sizeof(streamPosition));
+
+		if(read == 0)
+		{
+			length = buildFrame(FRAME_END, streamSequence, payload, sizeof(streamPosition), frame);
+			streamActive = false;
+		}
+		else if(streamPacked)
+		{
+			//As many entries as surely fit, the rest is read again for the next frame
+			uint16_t size = sizeof(streamPosition) + 1;
+			uint8_t packedCount = 0;
+			entryPacker.reset();
+			while(packedCount < read && size + ENTRYPACKER_MAX_PACKED <= FRAME_MAX_PAYLOAD)
 			{
-				displayMeas = false;
+				size += entryPacker.pack(entries + packedCount * MeasEntry::len, payload + size);
+				packedCount++;
 			}
+			payload[sizeof(streamPosition)] = packedCount;
+
+			length = buildFrame(FRAME_PACKED, streamSequence, payload, size, frame);
+			streamPosition += packedCount;
 		}
-		else if(matchResult == 2 && strcmp((const char*) commandBuffer, FREQ_command) == 0)
+		else
 		{
-			sscanf((const char*)argBuffer, "%lu", &measFrequency);
+			//The entries are sent as stored, the host decodes them
+			memcpy(payload + sizeof(streamPosition), entries, read * MeasEntry::len);
+			length = buildFrame(FRAME_ENTRIES, streamSequence, payload, sizeof(streamPosition) + read * MeasEntry::len, frame);
+			streamPosition += read;
 		}
+	}
+
+	streamSequence++;
+	txQueue.write(frame, length);
+}
+
+void startReception()
+{
+	rxDmaPosition = 0;
+	HAL_UARTEx_ReceiveToIdle_DMA(&huart2, rxDmaBuffer, RX_DMA_SIZE);
+}
+
+void setBaudRate(uint32_t rate_p)
+{
+	//Nothing is sent or received during the switch, the reception is started again on the new rate.
+	//A transfer cut off by the abort is dropped, the rest of the queue goes out on the new rate
+	HAL_UART_Abort(&huart2);
+	huart2.Init.BaudRate = rate_p;
+	if (HAL_UART_Init(&huart2) != HAL_OK)
+	{
+		Error_Handler();
+	}
+	startReception();
+	txQueue.onAbort();
+}
+
+void baudTask()
+{
+	if(baudState == BAUD_SWITCH && txQueue.isIdle())
+	{
+		previousBaudRate = huart2.Init.BaudRate;
+		setBaudRate(newBaudRate);
+		baudSwitchTime = HAL_GetTick();
+		baudState = BAUD_CONFIRM;
+	}
+	else if(baudState == BAUD_CONFIRM && (HAL_GetTick() - baudSwitchTime) > BAUD_CONFIRM_TIMEOUT)
+	{
+		//The host could not talk on the new rate
+		setBaudRate(previousBaudRate);
+		baudState = BAUD_IDLE;
+	}
+	else if(baudState == BAUD_IDLE && huart2.Init.BaudRate != DEFAULT_BAUD && !streamActive && txQueue.isIdle()
+			&& !(currentState == COMM && currentCommState != IDLE) && ((uint32_t)myClock.getTime() - lastRxActivity) >= BAUD_IDLE_TIMEOUT)
+	{
+		//Nothing received for a long time and nothing is being sent, a host that comes back (or a new one) starts on the default rate
+		setBaudRate(DEFAULT_BAUD);
+	}
+}
+
+void streamTask()
+{
+	//One frame per pass, so the acquisition events are handled between the frames. Held back while the queue has no room for it
+	if(streamActive && txQueue.getFree() > FRAME_MAX_ENCODED)
+	{
+		sendReadoutFrame();
+	}
+}
 
-		//If already in COMM accept COMM command
-		else if(currentState == COMM)
+void commTask()
+{
+	if(onEntry_comm)
+	{
+		//No ticks in COMM state, the RTC keeps the time
+		myClock.stopWakeup();
+		wakeupPeriod = 0;
+		tickPending = false;
+		onEntry_meas = true;
+		onEntry_comm = false;
+	}
+
+	switch (currentCommState)
+	{
+		case IDLE:
+			//do nothing
+			readoutPosition = 0;
+			break;
+		case INIT:
+		{
+			//The host's clock sets the RTC, the entries are counted from now on
+			myMS.init(initTimeastamp, timeUnit);
+			myClock.setTime(initTimeastamp);
+			lastStoreTime = initTimeastamp * 1000;
+			lastRxActivity = (uint32_t)myClock.getTime(); //Received on the old clock, the time since it would jump
+			currentCommState = IDLE;
+			break;
+		}
+		case READOUT:
 		{
-			if( strcmp((const char*) commandBuffer, CommIDLE_command) == 0)
+			//Sent in chunks, so the commands and the other events are handled during a long readout
+			//Held back while the queue has no room for a line, the DMA sends meanwhile
+			if(txQueue.getFree() < Buffer_Size)
 			{
-				currentCommState = IDLE;
+				break;
 			}
-			else if( strcmp((const char*) commandBuffer, CommREADOUT_command) == 0)
+
+			if(readoutPosition == 0)
 			{
-				currentCommState = READOUT;
+				sniprintf(msg, Buffer_Size, "%llu; %u; %u;\r\n", myMS.readTimestamp(), myMS.readCounter(), myMS.readTimeUnit());
+				txQueue.send(msg);
 			}
-			if(matchResult == 2 && strcmp((const char*) commandBuffer, CommINIT_command) == 0)
+
+			MeasEntry entryBuffer;
+			for(uint8_t n = 0; n < READOUT_CHUNK; n++)
 			{
-				if( sscanf((const char*)argBuffer, "%llu", &initTimeastamp) == 1)
+				if( txQueue.getFree() < Buffer_Size )
 				{
-					currentCommState = INIT;
+					break;
 				}
+
+				if( !myMS.getEntryAt(readoutPosition, &entryBuffer) )
+				{
+					snprintf(msg, Buffer_Size, "END\r\n");
+					txQueue.send(msg);
+					currentCommState = IDLE;
+					readoutPosition = 0;
+					break;
+				}
+
+				readoutPosition++;
+				snprintf(msg, Buffer_Size, "%u, %u, %lu;\r\n", entryBuffer.measID, entryBuffer.deltaT, entryBuffer.measData);
+				txQueue.send(msg);
 			}
+			break;
 		}
-	}//matchresult
+		default:
+			break;
+	}
+}
+
+void backgroundTasks()
+{
+	if(commandQueue.hasLine())//Its event was lost on a full event queue
+	{
+		onCommand(0);
+	}
+
+	if(calibrationAction != CAL_NONE)
+	{
+		bool calibrated = (calibrationAction == CAL_APPLY) ? mySensorBus.applyCalibration(calibrationID, &myMS) : mySensorBus.resetCalibration(calibrationID, &myMS);
+		calibrationAction = CAL_NONE;
+
+		snprintf(msg, Buffer_Size, calibrated ? "CAL OK\r\n" : "CAL FAIL\r\n");
+		txQueue.send(msg);
+	}
+
+	listingTask();
+	streamTask();
+	baudTask();
+
+	switch (currentState)
+	{
+		case MEAS:
+			measTask();
+			break;
+		case COMM:
+			commTask();
+			break;
+		default:
+			break;
+	}
+}
+
+void armRxWakeup()
+{
+	//The USART does not run in STOP mode, the falling edge of the start bit on its RX pin wakes up the MCU through EXTI line 3.
+	//The pin stays in alternate function mode, the EXTI sees its input anyway
+	__HAL_RCC_SYSCFG_CLK_ENABLE();
+	SYSCFG->EXTICR[0] = (SYSCFG->EXTICR[0] & ~SYSCFG_EXTICR1_EXTI3) | SYSCFG_EXTICR1_EXTI3_PA;
+	EXTI->FTSR |= EXTI_FTSR_TR3;
+	__HAL_GPIO_EXTI_CLEAR_IT(USART_RX_Pin);
+	HAL_NVIC_ClearPendingIRQ(EXTI3_IRQn);
+	EXTI->IMR |= EXTI_IMR_MR3;
+}
+
+void disarmRxWakeup()
+{
+	//A pending wakeup edge is still handled, only the further bytes do not interrupt
+	EXTI->IMR &= ~EXTI_IMR_MR3;
+}
+
+bool stopAllowed()
+{
+	//Only between the samples of the measurement, when nothing is sent and the host has been quiet for a while.
+	//Not while a filter or an alarm capture is fed: DRDY would wake up the MCU on every conversion and each wakeup locks the PLL again,
+	//SLEEP mode costs less then. In deadband mode the DRDY interrupt is off, in low-duty mode the devices only convert for the sweeps
+	return currentState == MEAS && txQueue.isIdle() && !streamActive && currentListing == LIST_NONE && !tickPending
+			&& !(appliedLoggingMode != LOG_DEADBAND && mySensorBus.isAcquiring())
+			&& ((uint32_t)myClock.getTime() - lastRxActivity) >= STOP_HOLDOFF;
+}
+
+void enterStop()
+{
+	//Nothing uses the conversions until the next sweep, so the devices pause and DRDY does not wake up the MCU.
+	//In deadband mode they go on converting, the window is checked in hardware and the DRDY interrupt is already off
+	bool pauseConversions = appliedLoggingMode != LOG_DEADBAND && !mySensorBus.isDutyCycled();
+	if(pauseConversions)
+	{
+		mySensorBus.stopContinousMeas();
+		EXTI->IMR &= ~TEMP_RDY_Pin;
+	}
+
+	//Only the RTC wakeup, the DRDY line and the RX pin wake up the MCU. The PLL is off after the wakeup, the clocks are set again
+	//before the interrupt runs, as the interrupts are masked here
+	armRxWakeup();
+	HAL_SuspendTick();
+	HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+	SystemClock_Config();
+	HAL_ResumeTick();
+	disarmRxWakeup();
+
+	if(pauseConversions)
+	{
+		//The first conversion is ready well before the sweep times out
+		mySensorBus.resumeContinousMeas();
+		__HAL_GPIO_EXTI_CLEAR_IT(TEMP_RDY_Pin);
+		EXTI->IMR |= TEMP_RDY_Pin;
+	}
+}
+
+void enterSleep()
+{
+	//A readout in progress is continued on the next pass, if it waits for the transmit queue the end of the transfer wakes the MCU up
+	bool readoutRunning = (currentState == COMM && currentCommState != IDLE) || streamActive;
+	if(readoutRunning && txQueue.getFree() > FRAME_MAX_ENCODED)
+	{
+		return;
+	}
+
+	//The SysTick is only stopped if no health check, sweep, leaving of the low-duty mode or baud rate confirmation has to be timed
+	if(mySensorBus.isFaultDetectionBusy() || sweepRunning || acquisitionAction != ACQ_KEEP || baudState != BAUD_IDLE)
+	{
+		HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+	}
+	else if(stopAllowed())
+	{
+		enterStop();
+	}
+	else
+	{
+		HAL_SuspendTick();
+		HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+		//...
+		HAL_ResumeTick();
+	}
 }
 
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
 {
-	sendComplete = true;
+	if (huart->Instance == USART2)
+	{
+		txQueue.onTransmitComplete();
+	}
 }
 
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+//Called on the IDLE line, the half and the full transfer, Size is where the DMA writes next in the buffer
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
     if (huart->Instance == USART2) // Ellenőrizni, hogy melyik UART periféria váltotta ki a megszakítást
     {
-    	if(idx > Buffer_Size)
+    	uint16_t end = (Size >= RX_DMA_SIZE) ? 0 : Size;
+    	bool lineCompleted = false;
+
+    	//Only queued here, the lines are parsed in the main context
+    	while( rxDmaPosition != end )
     	{
-    		idx = 0;
+    		if( commandQueue.putByte(rxDmaBuffer[rxDmaPosition]) )
+    		{
+    			lineCompleted = true;
+    		}
+    		rxDmaPosition = (rxDmaPosition + 1) % RX_DMA_SIZE;
     	}
 
-    	memcpy(RxData+idx, tmp, 1);
-    	idx++;
-
-    	if (tmp[0] == '\r')
+    	//One event is enough, the handler takes every completed line
+    	if( lineCompleted )
     	{
-    		RxData[idx-1] = '\0';//change \r to \0
-    		memcpy(FinalData, RxData, Buffer_Size);
-    		idx = 0;
-    		handleMessage();
+    		myScheduler.post(EVENT_COMMAND);
     	}
-
-
-    	HAL_UART_Receive_IT(&huart2, tmp, 1);
-
     }
 }
 
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	//An overrun or framing error stops the DMA, the reception is started again from the beginning of the buffer
+	if (huart->Instance == USART2)
+	{
+		if (huart->RxState == HAL_UART_STATE_READY)
+		{
+			startReception();
+		}
+		txQueue.onError();
+	}
+}
+
 
 
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
 {
+  if(GPIO_Pin == TEMP_RDY_Pin)
+  {
+	  //Captured first, so the time of the conversion does not depend on the interrupt latency
+	  drdyCapture = captureClock.now();
+	  drdyCaptured = true;
+
+	  //The conversion is read out in the main context, so the SPI bus is never used from two contexts
+	  myScheduler.post(EVENT_DRDY);
+  }
+  else if(GPIO_Pin == USART_RX_Pin)
+  {
+	  //The host started talking during STOP mode, the first byte is lost, the rest is received in SLEEP mode
+	  lastRxActivity = (uint32_t)myClock.getTime();
+  }
   HAL_ResumeTick();
 }
+
+void RTC_WakeupCallback(void)
+{
+	myClock.clearWakeup();
+	myScheduler.post(EVENT_TICK);
+}
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -288,14 +1326,27 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_USART2_UART_Init();
   MX_I2C1_Init();
   MX_SPI1_Init();
-  MX_TIM3_Init();
+  MX_TIM5_Init();
   /* USER CODE BEGIN 2 */
 
-  myPT100.init();
-  myPT100.startContinousMeas();
+  //Keeps the time over a reset if the backup domain stayed powered
+  myClock.init();
+  captureClock.start();
+  lastStoreTime = myClock.getTimeMs();
+  HAL_NVIC_SetPriority(EXTI3_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI3_IRQn);
+
+  //Further channels: one GPIO pair, one MAX31865 instance and one addSensor line each
+  mySensorBus.addSensor(&myPT100, 1);
+  mySensorBus.init();
+  mySensorBus.loadCalibrations(&myMS); //Applied in the conversion of every sample, no post-processing is needed
+  timeUnit = myMS.readTimeUnit(); //The session goes on after a reset
+  mySensorBus.startContinousMeas();
+  mySensorBus.setFilter(filterType, filterParam);
 
   uint8_t devices[128];
   i2cScann(&hi2c1, devices);
@@ -327,122 +1378,27 @@ int main(void)
 
   */
 
-  HAL_UART_Receive_IT(&huart2, tmp, 1);
+  myScheduler.init();
+  myScheduler.attach(EVENT_TICK, onTick);
+  myScheduler.attach(EVENT_COMMAND, onCommand);
+  myScheduler.attach(EVENT_DRDY, onDrdy);
+  myScheduler.setPollHook(backgroundTasks);
+  myScheduler.setIdleHook(enterSleep);
 
-  bool onEntry_meas = true;
-  bool onEntry_comm = true;
+  //The DMA fills the buffer in a circle without the CPU, an interrupt only comes on an idle line or at every half of the buffer
+  startReception();
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
-  MeasEntry entryBuffer;
   while (1)
   {
 	  //@todo: bosch laptopból kinézni hogyan is volt a %llu, illetve a command - argument dolog, hogy tudjak initelni
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
-	  /* switch-case -> állapotgép
-	   * az állapotot lehessen lekérdezni is, ezt a beérkező parancsokat kezelő fgv.-ben kell kezelni.
-	   *
-	   * */
-		switch (currentState)
-		{
-			case MEAS:
-			{
-				if(onEntry_meas)//Start the timer
-				{
-					HAL_TIM_Base_Start_IT(&htim3);
-					onEntry_meas = false;
-					onEntry_comm = true;
-					currentCommState = IDLE; //The next time COMM state is entered it will be idle
-				}
-
-				if(timeInterruptTick)//Storing the Data
-				{
-					float tempMeas = myPT100.getTemp();
-					uint32_t data32;
-					memcpy(&data32, (const float*)&tempMeas, sizeof(uint32_t));
-
-					if(displayMeas)
-					{
-						snprintf(msg, Buffer_Size, "%0.3f \r\n", tempMeas);
-						HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
-					}
-
-
-
-					currentMeas.measID = 1;
-					currentMeas.deltaT = measFrequency+idleTime;
-					idleTime = 0;
-					currentMeas.measData = data32;
-
-
-					myMS.addEntry(currentMeas);
-
-					timeInterruptTick = false;
-				}
-
-				//Enter sleep mode
-				HAL_SuspendTick();
-				HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
-				//...
-				HAL_ResumeTick();
-
-				break;
-			}
-			case COMM:
-			{
-				if(onEntry_comm)
-				{
-					//HAL_TIM_Base_Stop_IT(&htim3);
-					onEntry_meas = true;
-					onEntry_comm = false;
-				}
-
-				switch (currentCommState)
-				{
-					case IDLE:
-						//do nothing
-						break;
-					case INIT:
-					{
-						myMS.init(initTimeastamp);
-						currentCommState = IDLE;
-						break;
-					}
-					case READOUT:
-					{
-						uint16_t cnt = 0;
-						sniprintf(msg, Buffer_Size, "%llu; %u;\r\n", myMS.readTimestamp(), myMS.readCounter());
-						HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
-						while(true)
-						{
-							if( !myMS.getEntryAt(cnt, &entryBuffer) )
-							{
-								break;
-							}
-							else
-							{
-								cnt++;
-								snprintf(msg, Buffer_Size, "%u, %u, %lu;\r\n", entryBuffer.measID, entryBuffer.deltaT, entryBuffer.measData);
-								HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
-							}
-						}
-						snprintf(msg, Buffer_Size, "END\r\n");
-						HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen(msg), HAL_MAX_DELAY);
-						currentCommState = IDLE;
-						break;
-					}
-					default:
-						break;
-				}
-			}
-				break;
-			default:
-				break;
-		}
-
+	  //The events posted by the interrupts are handled to completion, then the polled work is advanced and the MCU sleeps until the next interrupt
+	  myScheduler.runOnce();
   }
   /* USER CODE END 3 */
 }
@@ -567,47 +1523,47 @@ static void MX_SPI1_Init(void)
 }
 
 /**
-  * @brief TIM3 Initialization Function
+  * @brief TIM5 Initialization Function
   * @param None
   * @retval None
   */
-static void MX_TIM3_Init(void)
+static void MX_TIM5_Init(void)
 {
 
-  /* USER CODE BEGIN TIM3_Init 0 */
+  /* USER CODE BEGIN TIM5_Init 0 */
 
-  /* USER CODE END TIM3_Init 0 */
+  /* USER CODE END TIM5_Init 0 */
 
   TIM_ClockConfigTypeDef sClockSourceConfig = {0};
   TIM_MasterConfigTypeDef sMasterConfig = {0};
 
-  /* USER CODE BEGIN TIM3_Init 1 */
+  /* USER CODE BEGIN TIM5_Init 1 */
 
-  /* USER CODE END TIM3_Init 1 */
-  htim3.Instance = TIM3;
-  htim3.Init.Prescaler = 8400-1;
-  htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim3.Init.Period = 10000-1;
-  htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-  htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-  if (HAL_TIM_Base_Init(&htim3) != HAL_OK)
+  /* USER CODE END TIM5_Init 1 */
+  htim5.Instance = TIM5;
+  htim5.Init.Prescaler = 84-1;
+  htim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim5.Init.Period = 4294967295;
+  htim5.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim5.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  if (HAL_TIM_Base_Init(&htim5) != HAL_OK)
   {
     Error_Handler();
   }
   sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
-  if (HAL_TIM_ConfigClockSource(&htim3, &sClockSourceConfig) != HAL_OK)
+  if (HAL_TIM_ConfigClockSource(&htim5, &sClockSourceConfig) != HAL_OK)
   {
     Error_Handler();
   }
   sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
   sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
-  if (HAL_TIMEx_MasterConfigSynchronization(&htim3, &sMasterConfig) != HAL_OK)
+  if (HAL_TIMEx_MasterConfigSynchronization(&htim5, &sMasterConfig) != HAL_OK)
   {
     Error_Handler();
   }
-  /* USER CODE BEGIN TIM3_Init 2 */
+  /* USER CODE BEGIN TIM5_Init 2 */
 
-  /* USER CODE END TIM3_Init 2 */
+  /* USER CODE END TIM5_Init 2 */
 
 }
 
@@ -644,6 +1600,25 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream5_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -679,10 +1654,14 @@ static void MX_GPIO_Init(void)
 
   /*Configure GPIO pin : TEMP_RDY_Pin */
   GPIO_InitStruct.Pin = TEMP_RDY_Pin;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
   GPIO_InitStruct.Pull = GPIO_NOPULL;
   HAL_GPIO_Init(TEMP_RDY_GPIO_Port, &GPIO_InitStruct);
 
+  /* EXTI interrupt init*/
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+
 /* USER CODE BEGIN MX_GPIO_Init_2 */
 /* USER CODE END MX_GPIO_Init_2 */
 }
@@ -690,21 +1669,10 @@ static void MX_GPIO_Init(void)
 /* USER CODE BEGIN 4 */
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
-	if(htim == &htim3)
+	if(htim == &htim5)
 	{
-		timerInterruptCntr++;
-		if(currentState != MEAS)
-		{
-			idleTime++;
-		}
-		if(( (timerInterruptCntr % measFrequency) == 0 ) && currentState == MEAS)
-		{
-			timeInterruptTick = true;
-			timerInterruptCntr = 0;
-		}
-		/*char msg2[20];
-		snprintf(msg2, 20, "Interrupt Called\r\n");
-		HAL_UART_Transmit(&huart2, (uint8_t*)msg2, 20, HAL_MAX_DELAY);*/
+		//The upper half of the microsecond time
+		captureClock.onOverflow();
 	}
 }
 /* USER CODE END 4 */
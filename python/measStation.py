@@ -3,9 +3,75 @@ import serial.tools.list_ports
 import time
 import pandas as  pd
 import struct
+import binascii
+import json
+import os
+import contextlib
 from datetime import datetime, timezone, timedelta
 from tqdm import tqdm
 
+###
+# @brief measID of the header entry of an alarm burst
+# #
+BURST_HEADER_ID = 0xFF
+
+###
+# @brief Set in the measID of the samples of an alarm burst
+# #
+BURST_FLAG = 0x80
+
+###
+# @brief Frame types of the binary readout
+# #
+FRAME_HEADER = 0x01
+FRAME_ENTRIES = 0x02
+FRAME_END = 0x03
+FRAME_PACKED = 0x04
+
+###
+# @brief Channels whose previous measData the packer of the device keeps
+# #
+PACKER_CHANNELS = 16
+
+###
+# @brief Inline difference of a packed entry that means a varint follows
+# #
+PACKER_ESCAPE = 63
+
+###
+# @brief Baud rate of the device after reset
+# #
+DEFAULT_BAUD = 115200
+
+###
+# @brief Baud rate asked for the bulk readouts, the default one is kept if the link does not work on it
+# #
+FAST_BAUD = 2000000
+
+###
+# @brief Time unit of deltaT in ms of the storages that do not give one
+# #
+DEFAULT_TIME_UNIT = 1000
+
+###
+# @brief Time the device needs to leave STOP mode after the first edge on its RX line [s]
+# #
+WAKE_DELAY = 0.005
+
+###
+# @brief Raised by a sync if the storage has been initialized again since the cached entries were read
+# #
+class SessionChanged(Exception):
+    def __init__(self, timeStamp: int) -> None:
+        super().__init__("The storage has been initialized again")
+        self.timeStamp = timeStamp
+
+###
+# @brief Raised on a corrupted or lost frame of the binary readout
+# #
+class FrameError(Exception):
+    pass
+
 ###
 # @brief Class to access the functions of the MEAS station
 # 
@@ -19,6 +85,11 @@ class MeasStation:
     # The device is automatically detected
     # #
     def __init__(self) -> None:
+        ###
+        # @brief The baud rate the device uses now. (int)
+        # #
+        self.baudRate = DEFAULT_BAUD
+
         if( self.autoDetect() == False ):
             raise Exception("Instance could not be initialized as autodetection failed!")
 
@@ -48,6 +119,17 @@ class MeasStation:
                 print(f"\t\tport {port} could not be opened.")
         return False
 
+    ###
+    # @brief Writes a command line to the open port
+    #
+    # Between the samples the device may be in STOP mode, where the first byte only wakes it up and is lost.
+    # A line ending is sent first, it also ends the garbage of a lost byte, so the command itself is received whole.
+    # #
+    def _writeCommand(self, serialPort: serial.Serial, command: str) -> None:
+        serialPort.write(b'\r')
+        time.sleep(WAKE_DELAY)
+        serialPort.write(('\r' + command + '\r\n').encode())
+
     ###
     # @brief Sends a command to the device, without returning any response
     # 
@@ -55,8 +137,8 @@ class MeasStation:
     # @param command    The command that will be sent to the device e.g.: "enterComm"
     # #
     def _send_command_no_reply(self, port: str, command: str) -> None:
-        with serial.Serial(port, 115200, timeout=1) as serialPort:
-            serialPort.write((command + '\r\n').encode())
+        with serial.Serial(port, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, command)
 
     ###
     # @brief Sends a command to the device and returns the first line 
@@ -68,8 +150,8 @@ class MeasStation:
     # the measured data is constantly being printed. In order not to get stuck reading these replies this command can be used
     # 
     def _send_command_single_reply(self, port: str, command: str) -> str:
-        with serial.Serial(port, 115200, timeout=1) as serialPort:
-            serialPort.write((command + '\r\n').encode())
+        with serial.Serial(port, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, command)
             line = serialPort.readline().decode('utf-8').strip()
             return line
 
@@ -82,8 +164,8 @@ class MeasStation:
     # the measured data is constantly being printed. In order not to get stuck reading these replies this command can be used
     # 
     def send_command_single_reply(self, command: str) -> str:
-        with serial.Serial(port, 115200, timeout=1) as serialPort:
-            serialPort.write((command + '\r\n').encode())
+        with serial.Serial(port, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, command)
             line = serialPort.readline().decode('utf-8').strip()
             return line
 
@@ -95,8 +177,8 @@ class MeasStation:
     # @note Not to use if for the device is periodically sending some data e.g.: MEAS mode if displayMeas is turned on 
     # 
     def send_command(self, command: str) -> list:
-        with serial.Serial(self.serialPort, 115200, timeout=1) as serialPort:
-            serialPort.write((command + '\r\n').encode())
+        with serial.Serial(self.serialPort, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, command)
             lines = serialPort.readlines()
             return lines
 
@@ -135,13 +217,16 @@ class MeasStation:
     # @brief Initializes the storage on the device with the current time
     # 
     # @warning After this function the device will be in COMM mode, to start the measurement call the enterMeasMode() function to enter the MEAS mode.
+    #
+    # @param timeUnit   Time unit of the stored time differences in ms for this measurement. A finer unit allows shorter periods,
+    #                   but the largest gap between two entries is 65535 units. None lets the device choose: 1 s, or 10 ms if the period is shorter than a second
     # 
-    def initStorage(self) -> None:
-        local_now = datetime.now()
-        utcTimestamp = (local_now - datetime(1970, 1, 1)).total_seconds()
+    def initStorage(self, timeUnit: int = None) -> None:
+        # The device sets its real-time clock from it, the entries are timed by that clock
+        utcTimestamp = int(datetime.now(timezone.utc).timestamp())
 
         self.enterCommMode()
-        self._send_command_no_reply(self.serialPort, f"INIT {utcTimestamp}")
+        self._send_command_no_reply(self.serialPort, f"INIT {utcTimestamp}" + (f" {timeUnit}" if timeUnit is not None else ""))
 
     ###
     # @brief Reads out the storage on the device and returns a pandas data frame containing the records.
@@ -149,47 +234,559 @@ class MeasStation:
     # @warning After this function the device will be in COMM mode, to start the measurement call the enterMeasMode() function to enter the MEAS mode.
     # 
     def readoutStorage(self) -> pd.DataFrame:
-        with serial.Serial("COM9", 115200, timeout=1) as serialPort:
-            serialPort.write(("enterComm" + '\r\n').encode())
-            serialPort.write(("READOUT" + '\r\n').encode())
+        with serial.Serial("COM9", self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, "enterComm")
+            self._writeCommand(serialPort, "READOUT")
             line = serialPort.readline().decode('utf-8').strip()
-            timeStamp = int(line.split(';')[0])
-            entryCnt = int(line.split(';')[1])
+            header = [field.strip() for field in line.split(';')]
+            timeStamp = int(header[0])
+            entryCnt = int(header[1])
+            timeUnit = int(header[2]) if len(header) > 2 and header[2] != "" else DEFAULT_TIME_UNIT
 
-            # Get date time from the timestamp
-            startTime = datetime.fromtimestamp(timeStamp, timezone.utc)
-            
-            CumulativeTime = 0
-            data = []
+            entries = []
             for i in tqdm(range(entryCnt), desc="Loading..."):
                 raw_line = serialPort.readline().decode('utf-8').strip()
                 fields = raw_line.split(', ')
                 
                 # Átalakítás és adat hozzáadása a listához
-                measurement_type = int(fields[0])
-                delta_seconds = int(fields[1])
-
-                CumulativeTime += delta_seconds
-                
-                time = startTime + timedelta(seconds=CumulativeTime)
-                
-                # Visszaalakítás float-tá
-                uint_value = int(fields[2].strip(';'))
-                float_value = struct.unpack('!f', struct.pack('!I', uint_value))[0]
-                
-                data.append([measurement_type, time, float_value])
+                entries.append((int(fields[0]), int(fields[1]), int(fields[2].strip(';'))))
             
             if serialPort.readline().decode('utf-8').strip() != "END":
                 raise Exception("End signal not received")
 
-            # DataFrame létrehozása
-            df = pd.DataFrame(data, columns=['Measurement Type', 'Time', 'Value'])
-            return df
+            return self._entriesToDataFrame(timeStamp, entries, timeUnit)
+
+    ###
+    # @brief Reads out the storage in binary frames and returns a pandas data frame containing the records, like readoutStorage()
+    #
+    # The entries are sent as stored, in COBS encoded frames with sequence numbers and CRC-16, about a third of the text readout.
+    # A corrupted or lost frame raises an exception.
+    #
+    # The device keeps its state, in MEAS mode it goes on measuring during the readout and the entries stored meanwhile are left for the next one.
+    #
+    # @param baudRate   The rate asked for the readout, None keeps the current one
+    # @param packed     If True the device compresses the entries, usually to less than half
+    # #
+    def readoutStorageBinary(self, baudRate: int = FAST_BAUD, packed: bool = True) -> pd.DataFrame:
+        entries = []
+        with self._linkSpeed(baudRate):
+            timeStamp, entryCnt, timeUnit = self._readEntriesBinary(0, 0xFFFF, entries, packed=packed)
+        return self._entriesToDataFrame(timeStamp, entries, timeUnit)
+
+    ###
+    # @brief Reads only the entries stored since the last sync and returns every entry of the measurement as a pandas data frame
+    #
+    # The entries already read are kept in a local cache together with the timestamp of the measurement, which identifies it.
+    # Each request asks for at most chunkSize entries from the end of the cache. Every checked frame is added to the cache at once,
+    # so after a lost connection or a corrupted frame the next attempt resumes from the last good frame.
+    # If the storage has been initialized again since the last sync, the cache starts over.
+    # The device keeps its state, in MEAS mode it goes on measuring during the sync.
+    #
+    # @param cacheFile  If given, the cache is kept in this JSON file, so the syncs continue across runs
+    # @param chunkSize  Most entries asked for in one request
+    # @param retries    Number of times a failed request is resumed
+    # @param baudRate   The rate asked for the sync, None keeps the current one
+    # @param packed     If True the device compresses the entries, usually to less than half
+    # #
+    def syncStorage(self, cacheFile: str = None, chunkSize: int = 1024, retries: int = 3, baudRate: int = FAST_BAUD, packed: bool = True) -> pd.DataFrame:
+        with self._linkSpeed(baudRate):
+            cache = self._syncEntries(cacheFile, chunkSize, retries, packed)
+        return self._entriesToDataFrame(cache['timestamp'], cache['entries'], cache.get('timeUnit', DEFAULT_TIME_UNIT))
+
+    ###
+    # @brief The request loop of syncStorage()
+    #
+    # @returns The updated cache
+    # #
+    def _syncEntries(self, cacheFile: str, chunkSize: int, retries: int, packed: bool) -> dict:
+        cache = self._loadSyncCache(cacheFile)
+        failures = 0
+
+        while True:
+            received = []
+            try:
+                timeStamp, entryCnt, timeUnit = self._readEntriesBinary(len(cache['entries']), chunkSize, received, cache['timestamp'], packed)
+            except SessionChanged as changed:
+                cache = {'timestamp': changed.timeStamp, 'timeUnit': DEFAULT_TIME_UNIT, 'entries': []}
+                continue
+            except Exception:
+                cache['entries'] += received
+                self._saveSyncCache(cacheFile, cache)
+                failures += 1
+                if failures > retries:
+                    raise
+                continue
+
+            cache['timestamp'] = timeStamp
+            cache['timeUnit'] = timeUnit
+            cache['entries'] += received
+            self._saveSyncCache(cacheFile, cache)
+
+            if len(cache['entries']) >= entryCnt or len(received) == 0:
+                return cache
+
+    ###
+    # @brief Switch the device to another baud rate
+    #
+    # The device answers at the old rate and switches, then the new rate is confirmed with a command sent at it.
+    # Without the confirmation the device goes back to the old rate after 1 s.
+    #
+    # @returns True if the new rate is in effect, else the old one is kept
+    # #
+    def negotiateBaud(self, baudRate: int) -> bool:
+        if baudRate == self.baudRate:
+            return True
+
+        with serial.Serial(self.serialPort, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, f"setBaud {baudRate}")
+            reply = ""
+            for _ in range(20):
+                line = serialPort.readline().decode('utf-8', errors='ignore').strip()
+                if line.startswith("BAUD") or line == "":
+                    reply = line
+                    break
+            if reply != f"BAUD {baudRate}":
+                return False
+
+        try:
+            with serial.Serial(self.serialPort, baudRate, timeout=0.5) as serialPort:
+                serialPort.reset_input_buffer()
+                self._writeCommand(serialPort, "confirmBaud")
+                for _ in range(20):
+                    line = serialPort.readline().decode('utf-8', errors='ignore').strip()
+                    if line == "BAUD CONFIRMED":
+                        self.baudRate = baudRate
+                        return True
+                    if line == "":
+                        break
+        except serial.SerialException:
+            pass
+
+        # The device returns to the old rate after its timeout
+        time.sleep(1.2)
+        return False
+
+    ###
+    # @brief Use a baud rate for the enclosed transfers and go back to the default one after them
+    #
+    # If the rate cannot be negotiated the transfers run at the current one.
+    # #
+    @contextlib.contextmanager
+    def _linkSpeed(self, baudRate: int):
+        switched = baudRate is not None and baudRate != self.baudRate and self.negotiateBaud(baudRate)
+        try:
+            yield
+        finally:
+            if switched:
+                self.negotiateBaud(DEFAULT_BAUD)
+
+    ###
+    # @brief Reads entries in binary frames
+    #
+    # @param start      Index of the first entry
+    # @param maxEntries Most entries to read
+    # @param entries    The checked entries are appended to it as (measID, deltaT, measData), also the ones before an error
+    # @param session    If given and the timestamp of the storage differs, SessionChanged is raised before any entry is read
+    # @param packed     If True the device compresses the entries
+    #
+    # @returns The timestamp of the measurement, the number of stored entries and the time unit of deltaT in ms
+    # #
+    def _readEntriesBinary(self, start: int, maxEntries: int, entries: list, session: int = None, packed: bool = False) -> tuple:
+        with serial.Serial(self.serialPort, self.baudRate, timeout=1) as serialPort:
+            serialPort.reset_input_buffer()
+            command = f"READBIN {start} {maxEntries}" + (" PACKED" if packed else "")
+            self._writeCommand(serialPort, command)
+
+            # The measurements displayed before the readout started arrive as an invalid block before the header
+            for attempt in range(4):
+                try:
+                    frameType, payload = self._readFrame(serialPort, 0)
+                except FrameError:
+                    continue
+                if frameType == FRAME_HEADER:
+                    break
+            else:
+                raise Exception("Header frame not received")
+            timeStamp, entryCnt, entryLen, first = struct.unpack('<QHBH', payload[:13])
+            # Older firmware does not send the unit, its entries are in seconds
+            timeUnit = struct.unpack('<H', payload[13:15])[0] if len(payload) >= 15 else DEFAULT_TIME_UNIT
+
+            if session is not None and timeStamp != session:
+                self._writeCommand(serialPort, "IDLE")
+                raise SessionChanged(timeStamp)
+
+            expected = first
+            sequence = 1
+            with tqdm(total=max(0, min(maxEntries, entryCnt - first)), desc="Loading...") as progress:
+                while True:
+                    frameType, payload = self._readFrame(serialPort, sequence)
+                    sequence += 1
+
+                    if frameType == FRAME_END:
+                        break
+
+                    first = struct.unpack('<H', payload[:2])[0]
+                    if first != expected:
+                        raise Exception(f"Entries from {first} received, {expected} expected")
+
+                    if frameType == FRAME_PACKED:
+                        received = self._unpackEntries(payload[3:], payload[2])
+                    else:
+                        received = [struct.unpack('<BHI', payload[offset:offset + entryLen]) for offset in range(2, len(payload), entryLen)]
+
+                    entries += received
+                    expected += len(received)
+                    progress.update(len(received))
+
+            return timeStamp, entryCnt, timeUnit
+
+    ###
+    # @brief Decodes the entries of a packed frame, the reverse of the EntryPacker of the device
+    #
+    # Each entry is a flag byte: bit 0: same measID as the previous entry, bit 1: same deltaT, bits 7..2: zigzag difference of measData
+    # from the previous one of the channel (63: a varint follows). The fields not derived from the previous entries follow the flag.
+    #
+    # @param data   The packed entries
+    # @param count  The number of entries
+    # #
+    def _unpackEntries(self, data: bytes, count: int) -> list:
+        entries = []
+        previousData = [0] * PACKER_CHANNELS
+        measID = 0
+        deltaT = 0
+        position = 0
+
+        def varint() -> int:
+            nonlocal position
+            value = 0
+            shift = 0
+            while True:
+                byte = data[position]
+                position += 1
+                value |= (byte & 0x7F) << shift
+                shift += 7
+                if byte < 0x80:
+                    return value
+
+        try:
+            for _ in range(count):
+                flag = data[position]
+                position += 1
+
+                if not flag & 0x01:
+                    measID = data[position]
+                    position += 1
+                if not flag & 0x02:
+                    deltaT = varint()
+
+                zigzag = flag >> 2
+                if zigzag == PACKER_ESCAPE:
+                    zigzag = varint()
+                difference = (zigzag >> 1) ^ -(zigzag & 1)
+
+                channel = measID & (PACKER_CHANNELS - 1)
+                measData = (previousData[channel] + difference) & 0xFFFFFFFF
+                previousData[channel] = measData
+
+                entries.append((measID, deltaT, measData))
+        except IndexError:
+            raise FrameError("Packed entries cut short")
+
+        return entries
+
+    ###
+    # @brief Loads the cache of syncStorage(), an empty one if there is no file
+    # #
+    def _loadSyncCache(self, cacheFile: str) -> dict:
+        if cacheFile is not None and os.path.exists(cacheFile):
+            with open(cacheFile) as f:
+                cache = json.load(f)
+            cache['entries'] = [tuple(entry) for entry in cache['entries']]
+            return cache
+        return {'timestamp': None, 'timeUnit': DEFAULT_TIME_UNIT, 'entries': []}
+
+    ###
+    # @brief Saves the cache of syncStorage() if a file is given
+    # #
+    def _saveSyncCache(self, cacheFile: str, cache: dict) -> None:
+        if cacheFile is not None:
+            with open(cacheFile, 'w') as f:
+                json.dump(cache, f)
+
+    ###
+    # @brief Reads and checks the next frame of the binary readout
+    #
+    # @param sequence   The expected sequence number
+    #
+    # @returns The type and the payload of the frame
+    # #
+    def _readFrame(self, serialPort: serial.Serial, sequence: int) -> tuple:
+        encoded = serialPort.read_until(b'\x00')
+        if len(encoded) == 0 or encoded[-1] != 0:
+            raise Exception("Frame not received")
+
+        frame = self._cobsDecode(encoded[:-1])
+        if len(frame) < 5 or binascii.crc_hqx(frame[:-2], 0xFFFF) != struct.unpack('<H', frame[-2:])[0]:
+            raise FrameError(f"Corrupted frame {sequence}")
+
+        received = struct.unpack('<H', frame[1:3])[0]
+        if received != sequence & 0xFFFF:
+            raise FrameError(f"Frame {sequence} lost")
+
+        return frame[0], frame[3:-2]
+
+    ###
+    # @brief Decodes a COBS encoded block without its closing zero
+    # #
+    def _cobsDecode(self, data: bytes) -> bytes:
+        output = bytearray()
+        i = 0
+        while i < len(data):
+            code = data[i]
+            if code == 0:
+                raise FrameError("Invalid COBS block")
+            output += data[i + 1:i + code]
+            i += code
+            if code < 0xFF and i < len(data):
+                output.append(0)
+        return bytes(output)
+
+    ###
+    # @brief Converts the read entries to a pandas data frame
+    #
+    # @param timeStamp  The start of the measurement (UTC seconds)
+    # @param entries    (measID, deltaT, measData) of every entry
+    # @param timeUnit   The unit of deltaT in ms
+    # #
+    def _entriesToDataFrame(self, timeStamp: int, entries: list, timeUnit: int = DEFAULT_TIME_UNIT) -> pd.DataFrame:
+        # Get date time from the timestamp
+        startTime = datetime.fromtimestamp(timeStamp, timezone.utc)
+        
+        # Counted in units, so the sum does not collect rounding errors
+        CumulativeUnits = 0
+        data = []
+        burst = None
+        burstCnt = 0
+        for measurement_type, delta_units, uint_value in entries:
+            # Alarm burst header, the samples of the burst follow it
+            if measurement_type == BURST_HEADER_ID:
+                burst = self._parseBurstHeader((CumulativeUnits + delta_units) * timeUnit / 1000, uint_value)
+                burstCnt += 1
+                continue
+
+            # Visszaalakítás float-tá
+            float_value = struct.unpack('!f', struct.pack('!I', uint_value))[0]
+
+            # Sample of an alarm burst, it does not advance the time
+            if measurement_type & BURST_FLAG:
+                data.append([measurement_type & ~BURST_FLAG, None, float_value, burstCnt])
+                burst['samples'].append(len(data) - 1)
+                self._timeBurst(data, burst, startTime)
+                continue
+
+            CumulativeUnits += delta_units
+            
+            time = startTime + timedelta(milliseconds=CumulativeUnits * timeUnit)
+            
+            data.append([measurement_type, time, float_value, 0])
+
+        # DataFrame létrehozása
+        df = pd.DataFrame(data, columns=['Measurement Type', 'Time', 'Value', 'Burst'])
+        return df
+
+    ###
+    # @brief Decodes the header entry of an alarm burst
+    #
+    # @param endTime    Time of the last sample of the burst since the start of the measurement in seconds
+    # @param value      measData of the header entry
+    # #
+    def _parseBurstHeader(self, endTime: int, value: int) -> dict:
+        return {
+            'measID':   (value >> 24) & 0xFF,
+            'trigger':  (value >> 16) & 0xFF,
+            'cause':    (value >> 12) & 0xF,
+            'period':   (value & 0xFFF) * 10e-6,
+            'endTime':  endTime,
+            'samples':  []
+        }
+
+    ###
+    # @brief Sets the time of every sample of a burst read so far, counting back from the last one
+    # #
+    def _timeBurst(self, data: list, burst: dict, startTime: datetime) -> None:
+        n = len(burst['samples'])
+        for k, row in enumerate(burst['samples']):
+            seconds = burst['endTime'] - (n - 1 - k) * burst['period']
+            data[row][1] = startTime + timedelta(seconds=seconds)
+
+    ###
+    # @brief Let the device choose the logging period by the rate of change of the temperature.
+    #
+    # The average number of stored samples stays at or below the one of the period set with setMeasFreq().
+    #
+    # @param minPeriod  Shortest period in seconds
+    # @param maxPeriod  Longest period in seconds
+    # @param step       Wanted change between two samples in celsius
+    # #
+    def setAdaptiveLogging(self, minPeriod: int = 1, maxPeriod: int = 60, step: float = 0.05) -> None:
+        self._send_command_no_reply(self.serialPort, f"setLogMode ADAPTIVE {minPeriod} {maxPeriod} {step}")
+
+    ###
+    # @brief Log with the fixed period set with setMeasFreq()
+    # #
+    def setPeriodicLogging(self) -> None:
+        self._send_command_no_reply(self.serialPort, "setLogMode PERIODIC")
+
+    ###
+    # @brief Select how the sensors are sampled
+    #
+    # @param lowDuty        If True the bias voltage is only turned on for the measurements (less current and self-heating), else the sensors convert continuously
+    # @param timeConstants  Number of input filter time constants the bias voltage settles before a measurement
+    # #
+    def setAcquisition(self, lowDuty: bool, timeConstants: int = 11) -> None:
+        if lowDuty:
+            self._send_command_no_reply(self.serialPort, f"setAcquisition DUTY {timeConstants}")
+        else:
+            self._send_command_no_reply(self.serialPort, "setAcquisition CONTINUOUS")
+
+    ###
+    # @brief Capture the conversions around an alarm. The bursts appear in the readout with their number in the 'Burst' column.
+    #
+    # @param low    Lower limit in celsius
+    # @param high   Upper limit in celsius
+    # @param pre    Number of conversions kept from before the alarm
+    # @param post   Number of conversions recorded after the alarm
+    # #
+    def setAlarm(self, low: float, high: float, pre: int = 40, post: int = 23) -> None:
+        self._send_command_no_reply(self.serialPort, f"setAlarm {low} {high} {pre} {post}")
 
     ###
-    # @brief Set how often a measurement should be taken in seconds. The smallest increment is 1 second.
+    # @brief Turn off the alarm capture
+    # #
+    def disableAlarm(self) -> None:
+        self._send_command_no_reply(self.serialPort, "setAlarm OFF")
+
+    ###
+    # @brief Sends a calibration command and waits for its reply, the measurements printed meanwhile are skipped
+    #
+    # @returns True if the device replied OK
+    # #
+    def _send_calibration_command(self, command: str) -> bool:
+        with serial.Serial(self.serialPort, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, command)
+            for _ in range(20):
+                line = serialPort.readline().decode('utf-8').strip()
+                if line.startswith("CAL"):
+                    return line.endswith("OK")
+                if line == "":
+                    break
+        return False
+
+    ###
+    # @brief Capture a calibration point of a channel
+    #
+    # The last sample of the channel is used, so the probe has to be at the reference temperature during the last measurement.
+    #
+    # @param measID     The measID of the channel
+    # @param point      1 or 2
+    # @param reference  The true temperature in celsius
+    # #
+    def captureCalibrationPoint(self, measID: int, point: int, reference: float) -> bool:
+        return self._send_calibration_command(f"calibrate {measID} {point} {reference}")
+
+    ###
+    # @brief Calibrate a channel from its two captured points and store the calibration on the device
+    #
+    # The calibration is applied to every later sample by the device, the readout needs no correction.
+    # #
+    def applyCalibration(self, measID: int) -> bool:
+        return self._send_calibration_command(f"calibrate {measID} APPLY")
+
+    ###
+    # @brief Remove the calibration of a channel
+    # #
+    def resetCalibration(self, measID: int) -> bool:
+        return self._send_calibration_command(f"calibrate {measID} RESET")
+
+    ###
+    # @brief Set how often a measurement should be taken in seconds, from 0.1 s.
+    #
+    # @note For a period shorter than a second initialize the storage after setting it, so the entries get a fine enough time unit
     # 
-    def setMeasFreq(self, frequency: int) -> None:
+    def setMeasFreq(self, frequency: float) -> None:
         self._send_command_no_reply(self.serialPort, f"setFrequency {frequency}")
 
     
+
+    ###
+    # @brief Get the largest time from an interrupt to its handler on the device since the last query
+    #
+    # @note Should be used in COMM state, so the reply is not mixed with the displayed measurements
+    #
+    # @returns The latencies in us by event ('tick', 'command', 'drdy') and the number of events lost on a full queue ('dropped')
+    # #
+    def getLatency(self) -> dict:
+        reply = self._send_command_single_reply(self.serialPort, "getLatency")
+        values = [int(v) for v in reply.split(';')]
+        return {'tick': values[0], 'command': values[1], 'drdy': values[2], 'dropped': values[3]}
+
+    ###
+    # @brief Get the time of the real-time clock of the device
+    #
+    # @note Should be used in COMM state, so the reply is not mixed with the displayed measurements
+    #
+    # @returns The time of the device ('time', UTC datetime) and its clock ('source', "LSE" crystal or "LSI" internal RC)
+    # #
+    def getClock(self) -> dict:
+        reply = self._send_command_single_reply(self.serialPort, "getClock")
+        values = [v.strip() for v in reply.split(';')]
+        return {'time': datetime.fromtimestamp(int(values[0]) / 1000, tz=timezone.utc), 'source': values[1]}
+
+    ###
+    # @brief Get the number of replies and displayed lines the device could not send because its transmit queue was full
+    #
+    # @returns The lost messages ('messages') and their size in bytes ('bytes') since the start of the device
+    # #
+    def getTxDropped(self) -> dict:
+        reply = self._send_command_single_reply(self.serialPort, "getTxDropped")
+        values = [int(v) for v in reply.split(';')]
+        return {'messages': values[0], 'bytes': values[1]}
+
+    ###
+    # @brief Sends a command and collects the reply lines up to the closing END line
+    # #
+    def _send_command_listing(self, command: str) -> list:
+        with serial.Serial(self.serialPort, self.baudRate, timeout=1) as serialPort:
+            self._writeCommand(serialPort, command)
+            lines = []
+            while True:
+                line = serialPort.readline().decode('utf-8').strip()
+                if line == "END" or line == "":
+                    return lines
+                lines.append(line)
+
+    ###
+    # @brief Get the commands of the device with their arguments
+    #
+    # @note Should be used in COMM state, so the reply is not mixed with the displayed measurements
+    # #
+    def listCommands(self) -> list:
+        return self._send_command_listing("help")
+
+    ###
+    # @brief Get the statistics of the commands since the start of the device
+    #
+    # @note Should be used in COMM state, so the reply is not mixed with the displayed measurements
+    #
+    # @returns A data frame with the number of handled and rejected lines and the longest run in us by command, and the number of unknown commands
+    # #
+    def getCommandStats(self) -> tuple:
+        rows = []
+        unknown = 0
+        for line in self._send_command_listing("stats"):
+            fields = [f.strip() for f in line.split(';')]
+            if fields[0] == "unknown":
+                unknown = int(fields[1])
+            else:
+                rows.append([fields[0], int(fields[1]), int(fields[2]), int(fields[3])])
+        return pd.DataFrame(rows, columns=['Command', 'Handled', 'Rejected', 'Longest [us]']), unknown